@@ -0,0 +1,39 @@
+"""Add imu_batches
+
+Revision ID: 5b7e2d9a41c3
+Revises: c2946b160eed
+Create Date: 2026-10-18 22:10:00.000000
+
+"""
+from typing import Sequence, Union
+
+from alembic import op
+import sqlalchemy as sa
+
+
+# revision identifiers, used by Alembic.
+revision: str = '5b7e2d9a41c3'
+down_revision: Union[str, Sequence[str], None] = 'c2946b160eed'
+branch_labels: Union[str, Sequence[str], None] = None
+depends_on: Union[str, Sequence[str], None] = None
+
+
+def upgrade() -> None:
+    """Upgrade schema."""
+    op.create_table('imu_batches',
+    sa.Column('id', sa.Integer(), nullable=False),
+    sa.Column('device_id', sa.String(), nullable=True),
+    sa.Column('seq', sa.Integer(), nullable=True),
+    sa.Column('payload', sa.JSON(), nullable=True),
+    sa.Column('ts', sa.DateTime(), nullable=True),
+    sa.PrimaryKeyConstraint('id')
+    )
+    op.create_index(op.f('ix_imu_batches_device_id'), 'imu_batches', ['device_id'], unique=False)
+    op.create_index(op.f('ix_imu_batches_id'), 'imu_batches', ['id'], unique=False)
+
+
+def downgrade() -> None:
+    """Downgrade schema."""
+    op.drop_index(op.f('ix_imu_batches_id'), table_name='imu_batches')
+    op.drop_index(op.f('ix_imu_batches_device_id'), table_name='imu_batches')
+    op.drop_table('imu_batches')
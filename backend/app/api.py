@@ -11,6 +11,14 @@ def create_sensor_reading(db: Session, reading: schema.SensorReadingCreate):
     return db_item
 
 
+def create_imu_batch(db: Session, device_id: str, payload: dict):
+    db_item = models.ImuBatch(device_id=device_id, seq=payload.get("seq"), payload=payload)
+    db.add(db_item)
+    db.commit()
+    db.refresh(db_item)
+    return db_item
+
+
 def create_alert(db: Session, device_id: str, alert_type: str, payload: dict):
     db_item = models.Alert(device_id=device_id, alert_type=alert_type, payload=payload)
     db.add(db_item)
@@ -9,6 +9,15 @@ class SensorReading(Base):
     payload = Column(JSON)
     ts = Column(DateTime, default=datetime.utcnow)
 
+class ImuBatch(Base):
+    # full-rate IMU batches (baby/<id>/imu), kept out of sensor_readings
+    __tablename__ = "imu_batches"
+    id = Column(Integer, primary_key=True, index=True)
+    device_id = Column(String, index=True)
+    seq = Column(Integer)
+    payload = Column(JSON)
+    ts = Column(DateTime, default=datetime.utcnow)
+
 class Alert(Base):
     __tablename__ = "alerts"
     id = Column(Integer, primary_key=True, index=True)
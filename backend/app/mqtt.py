@@ -1,12 +1,18 @@
 import os
 import json
+import time
 import asyncio
 import ssl
+from collections import OrderedDict
 
 from aiomqtt import Client, MqttError
 
 from .database import SessionLocal
 from . import api as crud
+from . import presence
+from .telemetry_codec import (
+    decode_telemetry, is_binary_telemetry, decode_imu_batch, TelemetryDecodeError
+)
 from decouple import config
 from loguru import logger
 
@@ -28,10 +34,153 @@ logger.info(f"MQTT_USER: {MQTT_USER}")
 logger.info(f"MQTT_PASS: {MQTT_PASS}")
 
 
-async def handle_message(topic: str, payload_str: str):
-    # topic format: baby/<device_id>/sensor or baby/<device_id>/alert
-    print(f"Received message on topic {topic}: {payload_str}")
-    logger.info(f"Received message on topic {topic}: {payload_str}")
+def decode_payload(typ: str, raw: bytes) -> dict:
+    # devices switched to binary frames ({"telemetry_format": "binary"}) send them on
+    # baby/<id>/sensor/bin, handled as "sensor" once decoded
+    if typ == "sensor" and is_binary_telemetry(raw):
+        try:
+            return decode_telemetry(raw)
+        except TelemetryDecodeError as e:
+            logger.warning(f"Dropping bad binary telemetry frame ({len(raw)} bytes): {e}")
+            return None
+
+    if typ == "imu":
+        try:
+            return decode_imu_batch(raw)
+        except TelemetryDecodeError as e:
+            logger.warning(f"Dropping bad IMU batch ({len(raw)} bytes): {e}")
+            return None
+
+    payload_str = raw.decode(errors="replace")
+    try:
+        return json.loads(payload_str)
+    except Exception:
+        return {"raw": payload_str}
+
+
+# last IMU batch sequence per device, for gap detection
+_imu_seq = {}
+
+
+def note_imu_gap(device_id: str, payload: dict):
+    seq = payload["seq"]
+    last = _imu_seq.get(device_id)
+    _imu_seq[device_id] = seq
+    if last is None:
+        return
+    missing = (seq - last - 1) & 0xFFFF
+    if missing and missing < 0x8000:
+        payload["missing_batches"] = missing
+        logger.warning(f"{device_id}: {missing} IMU batch(es) lost before seq {seq}")
+
+
+# alert ids ("<device>-<boot>-<seq>") already stored; a QoS 1 alert can arrive
+# more than once (DUP retries, replay from the device's flash queue)
+_ALERT_IDS_KEPT = 4096
+_seen_alert_ids = OrderedDict()
+# last alert (boot, seq) per device, for gap detection
+_alert_seq = {}
+
+
+def is_duplicate_alert(payload: dict) -> bool:
+    alert_id = payload.get("id")
+    if not alert_id:
+        return False
+    if alert_id in _seen_alert_ids:
+        return True
+    _seen_alert_ids[alert_id] = True
+    if len(_seen_alert_ids) > _ALERT_IDS_KEPT:
+        _seen_alert_ids.popitem(last=False)
+    return False
+
+
+def note_alert_gap(device_id: str, payload: dict):
+    boot, seq = payload.get("boot"), payload.get("seq")
+    if boot is None or seq is None:
+        return
+    last = _alert_seq.get(device_id)
+    if last is not None and last[0] == boot and seq <= last[1]:
+        return  # replayed from flash behind newer ones
+    _alert_seq[device_id] = (boot, seq)
+    if last is None:
+        return
+    missing = seq - last[1] - 1 if last[0] == boot else seq - 1
+    if missing > 0:
+        payload["missing_alerts"] = missing
+        logger.warning(f"{device_id}: {missing} alert(s) missing before seq {seq} (boot {boot})")
+
+
+# last per-topic sequence number per (device, topic), for gap detection
+_topic_seq = {}
+# device wall clock minus device time, from the last stamped message; places IMU batches
+_clock_offset = {}
+# latency summaries per topic, logged every _LATENCY_REPORT_EVERY messages
+_LATENCY_REPORT_EVERY = 100
+_latency = {}
+
+
+def note_topic_gap(device_id: str, typ: str, payload: dict):
+    seq = payload.get("seq")
+    if seq is None or typ in ("alert", "imu"):
+        return  # see note_alert_gap and note_imu_gap
+    # messages replayed from the device's flash queue are numbered apart from the live ones
+    key = (device_id, typ, bool(payload.get("stored")))
+    last = _topic_seq.get(key)
+    _topic_seq[key] = seq
+    if last is None or seq <= last:
+        return  # first message, or the device restarted its counters
+    missing = seq - last - 1
+    if missing:
+        payload["missing_messages"] = missing
+        logger.warning(f"{device_id}/{typ}: {missing} message(s) missing before seq {seq}")
+
+
+def note_latency(device_id: str, typ: str, payload: dict, received_ms: int):
+    """Split sample -> ingest into the device's queueing delay and broker/network transit."""
+    ts, t = payload.get("ts"), payload.get("t")
+    if ts is not None and t is not None:
+        _clock_offset[device_id] = ts - t
+    if ts is None and typ == "imu" and device_id in _clock_offset:
+        ts = payload["device_time_ms"] + _clock_offset[device_id]
+    if ts is None:
+        return
+    latency = {"total_ms": received_ms - ts}
+    if payload.get("stored"):
+        # qd ended when the message went to flash; the time it sat there is no transit
+        latency["stored"] = True
+        payload["latency"] = latency
+        record_latency(typ, "stored_total_ms", latency["total_ms"])
+        return
+    if "qd" in payload:
+        latency["queue_ms"] = payload["qd"]
+        latency["transit_ms"] = received_ms - ts - payload["qd"]
+    payload["latency"] = latency
+    record_latency(typ, "total_ms", latency["total_ms"])
+
+
+def record_latency(typ: str, stage: str, value_ms: float):
+    stats = _latency.setdefault((typ, stage), {"n": 0, "sum": 0.0, "max": 0.0})
+    stats["n"] += 1
+    stats["sum"] += value_ms
+    stats["max"] = max(stats["max"], value_ms)
+    if stats["n"] >= _LATENCY_REPORT_EVERY:
+        logger.info(f"latency {typ}/{stage}: n={stats['n']} "
+                    f"mean={stats['sum'] / stats['n']:.0f} ms max={stats['max']:.0f} ms")
+        _latency[(typ, stage)] = {"n": 0, "sum": 0.0, "max": 0.0}
+
+
+# last config_ack per device: the revision it answered and the parameter set in use
+_config_acks = {}
+
+
+def get_config_ack(device_id: str):
+    return _config_acks.get(device_id)
+
+
+async def handle_message(topic: str, raw: bytes):
+    # topic format: baby/<device_id>/<type>, binary telemetry on baby/<device_id>/sensor/bin
+    received_ms = int(time.time() * 1000)
+    logger.info(f"Received message on topic {topic}: {len(raw)} bytes")
 
     parts = str(topic).split("/")
     if len(parts) < 3:
@@ -39,11 +188,39 @@ async def handle_message(topic: str, payload_str: str):
     device_id = parts[1]
     typ = parts[2]
 
+    if typ == "status":
+        # retained presence / last will, kept in memory only
+        if not raw:
+            presence.clear_status(device_id)
+            return
+        payload = decode_payload(typ, raw)
+        if isinstance(payload, dict):
+            presence.update_status(device_id, payload)
+            logger.info(f"{device_id}: {payload.get('state')} (fw {payload.get('fw')})")
+        return
 
-    try:
-        payload = json.loads(payload_str)
-    except Exception:
-        payload = {"raw": payload_str}
+    payload = decode_payload(typ, raw)
+    if payload is None:
+        return
+    if typ == "config_ack":
+        # answers to baby/<id>/config, not stored in the database
+        _config_acks[device_id] = payload
+        if payload.get("status") in ("rejected", "busy"):
+            logger.warning(f"{device_id}: config v{payload.get('version')} {payload.get('status')} "
+                           f"({payload.get('error')})")
+        else:
+            logger.info(f"{device_id}: config v{payload.get('version')} {payload.get('status')}")
+        return
+    if typ == "imu":
+        note_imu_gap(device_id, payload)
+    if typ == "alert":
+        if is_duplicate_alert(payload):
+            logger.info(f"{device_id}: duplicate alert {payload.get('id')} ignored")
+            return
+        note_alert_gap(device_id, payload)
+    if isinstance(payload, dict) and "raw" not in payload:
+        note_topic_gap(device_id, typ, payload)
+        note_latency(device_id, typ, payload, received_ms)
 
     # Run DB operations in a separate thread to avoid blocking the event loop
     loop = asyncio.get_event_loop()
@@ -129,14 +306,19 @@ async def mqtt_listener():
                 logger.info(f"✓ Connected to MQTT broker: {MQTT_HOST}:{MQTT_PORT}")
                 # async with client.messages as messages:
                 await client.subscribe("baby/+/sensor")
-                await client.subscribe("baby/+/alert")
-                logger.info("✓ Subscribed to baby/+/sensor and baby/+/alert")
+                await client.subscribe("baby/+/sensor/bin")  # binary frames, off the JSON topic
+                await client.subscribe("baby/+/alert", qos=1)  # devices publish alerts with QoS 1
+                await client.subscribe("baby/+/imu")
+                await client.subscribe("baby/+/status", qos=1)  # retained, last will on disconnect
+                await client.subscribe("baby/+/config_ack", qos=1)
+                logger.info("✓ Subscribed to baby/+/sensor, baby/+/sensor/bin, baby/+/alert, baby/+/imu, "
+                            "baby/+/status and baby/+/config_ack")
                 
                 async for message in client.messages:
                     try:
                         topic = str(message.topic)
-                        payload = message.payload.decode()
-                        logger.debug(f"Raw message: {topic} -> {payload}")
+                        payload = bytes(message.payload)
+                        logger.debug(f"Raw message: {topic} -> {payload!r}")
                         
                         # Use semaphore to prevent flooding the thread pool/DB
                         # We spawn a waiter task that acquires semaphore then processes
@@ -160,15 +342,20 @@ async def _bounded_handle_message(topic, payload):
 
 def _process_message_db(device_id: str, typ: str, payload: dict):
     db = SessionLocal()
+    start = time.monotonic()
     try:
         if typ == "sensor":
             from .schema import SensorReadingCreate
             item = SensorReadingCreate(device_id=device_id, payload=payload)
             crud.create_sensor_reading(db, item)
+        elif typ == "imu":
+            # batch rate would crowd the readings out of the latest/history queries
+            crud.create_imu_batch(db, device_id, payload)
         elif typ == "alert":
             # Support both 'type' and 'alert' keys for the alert name
             alert_type = payload.get("type") or payload.get("alert") or "unknown"
             crud.create_alert(db, device_id, alert_type, payload)
+        record_latency(typ, "db_ms", (time.monotonic() - start) * 1000)
     except Exception as e:
         logger.error(f"DB Error processing message: {e}")
     finally:
@@ -1,4 +1,6 @@
+import json
 import ssl
+import time
 from paho.mqtt import publish
 
 # Your HiveMQ Cloud credentials
@@ -12,7 +14,8 @@ ssl_context = ssl.create_default_context()
 ssl_context.check_hostname = True
 ssl_context.verify_mode = ssl.CERT_REQUIRED
 
-payload = '{"temp_threshold":39}'
+# the device only applies a versioned config, seconds since the epoch as the revision
+payload = json.dumps({"config": {"schema": 1, "version": int(time.time()), "temp_threshold": 39}})
 publish.single(
     topic="baby/device123/config",
     payload=payload,
@@ -0,0 +1,41 @@
+"""Device presence from the retained baby/<id>/status messages.
+
+A device publishes {"state": "online", ...} retained after every connect and
+registers {"state": "offline"} as its MQTT last will, so the broker flips the
+retained message itself when the session dies. Subscribing to baby/+/status
+therefore yields the current state of every device at once, without waiting
+for telemetry or guessing from timestamps.
+"""
+import time
+
+# device_id -> last status payload, plus "since" (ms) when the state last changed
+_presence = {}
+
+
+def update_status(device_id: str, payload: dict):
+    state = payload.get("state")
+    if state not in ("online", "offline"):
+        return
+    prev = _presence.get(device_id)
+    now_ms = int(time.time() * 1000)
+    entry = dict(payload)
+    entry["since"] = prev["since"] if prev and prev.get("state") == state else now_ms
+    entry["updated"] = now_ms
+    _presence[device_id] = entry
+
+
+def clear_status(device_id: str):
+    # an empty retained message removes a decommissioned device
+    _presence.pop(device_id, None)
+
+
+def get_status(device_id: str):
+    return _presence.get(device_id)
+
+
+def online_devices():
+    return sorted(d for d, s in _presence.items() if s.get("state") == "online")
+
+
+def all_statuses():
+    return dict(_presence)
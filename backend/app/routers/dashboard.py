@@ -3,6 +3,7 @@ from sqlalchemy.orm import Session
 from datetime import datetime, timedelta
 from ..database import SessionLocal
 from .. import api as crud
+from .. import presence
 
 router = APIRouter(prefix="/dashboard")
 
@@ -24,17 +25,22 @@ def get_dashboard_stats(db: Session = Depends(get_db)):
     readings_24h = crud.get_readings_count(db, start_time=last_24h)
     alerts_24h = crud.get_alerts_count(db, start_time=last_24h)
     
-    # "Active" devices could be devices that have sent data in the last 24h
-    # For now, let's keep it simple and just count unique devices found in readings
-    # A improved "active" check would need a more complex query
+    # "Active" = connected to the broker right now, from the retained status
+    # messages and last wills (see presence.py)
+    online = presence.online_devices()
     
     return {
         "total_devices": total_devices,
         "readings_24h": readings_24h,
         "alerts_24h": alerts_24h,
-        "active_devices_estimate": total_devices # Placeholder logic
+        "active_devices": len(online),
+        "active_devices_estimate": len(online)  # kept for existing clients
     }
 
+@router.get("/presence")
+def get_presence():
+    return {"online": presence.online_devices(), "devices": presence.all_statuses()}
+
 @router.get("/devices")
 def get_known_devices(db: Session = Depends(get_db)):
     return {"devices": crud.get_unique_device_ids(db)}
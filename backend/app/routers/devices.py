@@ -1,3 +1,5 @@
+import time
+
 from fastapi import APIRouter, Depends, HTTPException
 from ..database import SessionLocal
 from .. import  api as crud
@@ -17,10 +19,61 @@ def get_telemetry(device_id: str, limit: int = 100):
         db.close()
 
 
+# fields of the device's versioned parameter set (device/DetectionConfig.h); anything
+# else in a push (cmd, telemetry_format, imu_batch, ...) is a command and passes through
+DETECTION_FIELDS = ("impact_g", "impact_slope_g", "gyro_spike", "fall_cooldown_ms", "alpha",
+                    "sensor_interval_ms", "temp_threshold", "publish")
+DETECTION_SCHEMA = 1
+
+# last revision handed out per device
+_config_versions = {}
+
+
+def next_config_version(device_id: str) -> int:
+    # the device only applies a revision above the one in use; seconds since the epoch keep
+    # that true across backend restarts, the acked and last assigned ones within a second
+    from .. import mqtt
+
+    ack = mqtt.get_config_ack(device_id) or {}
+    active = (ack.get("active") or {}).get("version", 0)
+    version = max(int(time.time()), _config_versions.get(device_id, 0) + 1, active + 1)
+    _config_versions[device_id] = version
+    return version
+
+
+def wrap_config(device_id: str, body: dict) -> dict:
+    # {"temp_threshold": x} and {"config": {...}} both become a versioned {"config": {...}}
+    message = {k: v for k, v in body.items() if k != "config" and k not in DETECTION_FIELDS}
+    cfg = dict(body.get("config") or {})
+    cfg.update({k: v for k, v in body.items() if k in DETECTION_FIELDS})
+    if cfg:
+        cfg.setdefault("schema", DETECTION_SCHEMA)
+        if "version" in cfg:
+            _config_versions[device_id] = max(_config_versions.get(device_id, 0), int(cfg["version"]))
+        else:
+            cfg["version"] = next_config_version(device_id)
+        message["config"] = cfg
+    return message
+
+
 @router.post("/{device_id}/config")
 async def push_config(device_id: str, config: dict):
     from .. import mqtt
     
     topic = f"baby/{device_id}/config"
-    await mqtt.publish_message(topic, config)
-    return {"status": "success", "message": "Config pushed to device", "topic": topic}
+    message = wrap_config(device_id, config)
+    await mqtt.publish_message(topic, message)
+    version = message.get("config", {}).get("version")
+    # the device answers on baby/<id>/config_ack; GET .../config shows it once it is in use
+    return {"status": "success", "message": "Config pushed to device", "topic": topic, "version": version}
+
+
+@router.get("/{device_id}/config")
+def get_config(device_id: str):
+    # the device answers every config push on baby/<id>/config_ack with the set in use
+    from .. import mqtt
+
+    ack = mqtt.get_config_ack(device_id)
+    if ack is None:
+        raise HTTPException(status_code=404, detail="No config acknowledgement from this device yet")
+    return ack
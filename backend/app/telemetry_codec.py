@@ -0,0 +1,201 @@
+"""
+Decoders for the binary payloads published by the device firmware.
+
+decode_telemetry() turns a sensor frame (device/TelemetryCodec.h) into the
+same dict shape as the JSON telemetry, so storage and the API do not care
+which format a device uses. decode_imu_batch() expands a delta-encoded
+full-rate IMU batch (device/ImuBatch.h) into raw sample rows.
+"""
+import struct
+
+MAGIC = b"MT"
+TYPE_SAMPLE = 1
+
+ENV_BARO = 0x01
+ENV_HUM = 0x02
+ENV_AIR = 0x04
+ENV_LIGHT = 0x08
+FLAG_NO_IMU = 0x40
+FLAG_STORED = 0x80
+
+# version 1: time, env flags, acc x/y/z/net, gyro x/y/z/mag, tilt x/y/z, temp, thresTemp
+_SAMPLE_V1 = struct.Struct("<IB13h")
+
+# version 3 window aggregates, in AggChannel order (device/WindowStats.h): name, fixed point
+# scale (TELEMETRY_AGG_SCALE in device/TelemetryCodec.cpp), decimals of the JSON encoding
+AGG_CHANNELS = (("acc_x", 1, 1), ("acc_y", 1, 1), ("acc_z", 1, 1), ("net", 1, 1), ("gyro", 10, 1),
+                ("temp", 100, 2), ("pressure", 10, 2), ("humidity", 100, 1), ("co2", 1, 0),
+                ("tvoc", 1, 0), ("light", 0.5, 0))
+
+
+class TelemetryDecodeError(ValueError):
+    pass
+
+
+def is_binary_telemetry(payload: bytes) -> bool:
+    return len(payload) >= 4 and payload[:2] == MAGIC
+
+
+def crc16_ccitt(data: bytes) -> int:
+    """CRC-16/CCITT-FALSE, same as telemetryCrc16() on the device."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def decode_telemetry(payload: bytes) -> dict:
+    if not is_binary_telemetry(payload):
+        raise TelemetryDecodeError("not a binary telemetry frame")
+    if len(payload) < 4 + _SAMPLE_V1.size + 2:
+        raise TelemetryDecodeError("frame too short")
+
+    body, (crc,) = payload[:-2], struct.unpack("<H", payload[-2:])
+    if crc16_ccitt(body) != crc:
+        raise TelemetryDecodeError("CRC mismatch")
+
+    version, typ = body[2], body[3]
+    if version not in (1, 2, 3) or typ != TYPE_SAMPLE:
+        raise TelemetryDecodeError(f"unsupported frame version {version} type {typ}")
+
+    (time_ms, flags, ax, ay, az, net, gx, gy, gz, gmag,
+     tx, ty, tz, temp, thres) = _SAMPLE_V1.unpack_from(body, 4)
+    offset = 4 + _SAMPLE_V1.size
+
+    def take(fmt):
+        nonlocal offset
+        try:
+            values = struct.unpack_from("<" + fmt, body, offset)
+        except struct.error as e:
+            raise TelemetryDecodeError("truncated frame") from e
+        offset += struct.calcsize("<" + fmt)
+        return values
+
+    env = {}
+    if flags & ENV_BARO:
+        pressure, baro_temp = take("Hh")
+        env["pressure"] = pressure / 10
+        env["baro_temp"] = baro_temp / 100
+    if flags & ENV_HUM:
+        humidity, hum_temp = take("Hh")
+        env["humidity"] = humidity / 100
+        env["hum_temp"] = hum_temp / 100
+    if flags & ENV_AIR:
+        env["co2"], env["tvoc"] = take("HH")
+    if flags & ENV_LIGHT:
+        env["light"], env["proximity"] = take("HB")
+
+    # version 2 appends seq, wall-clock ms of the sample (0 = not synced), queueing delay ms
+    stamp = {}
+    if version >= 2:
+        seq, wall_ms, queued_ms = take("IQI")
+        stamp = {"seq": seq, "t": time_ms, "qd": queued_ms}
+        if wall_ms:
+            stamp["ts"] = wall_ms
+        if flags & FLAG_STORED:
+            stamp["stored"] = True
+
+    # version 3 appends the window aggregates, the same [n, min, max, mean, std, over] as the JSON
+    agg = None
+    if version >= 3:
+        window_ms, mask = take("IH")
+        agg = {"window_ms": window_ms}
+        for n, (name, scale, decimals) in enumerate(AGG_CHANNELS):
+            if mask & (1 << n):
+                count, lo, hi, mean, std, over = take("HhhhHH")
+                values = [v / scale for v in (lo, hi, mean, std)]
+                values = [round(v, decimals) if decimals else round(v) for v in values]
+                agg[name] = [count, *values, over]
+    if offset != len(body):
+        raise TelemetryDecodeError("trailing bytes after the frame")
+
+    # a device without an IMU sends environment only samples, like its JSON
+    readings = {}
+    if not flags & FLAG_NO_IMU:
+        readings = {
+            "acc": {"x": ax, "y": ay, "z": az, "net": net},
+            "gyro": {"x": gx / 10, "y": gy / 10, "z": gz / 10, "mag": gmag / 10},
+            "tilt": {"x": tx / 100, "y": ty / 100, "z": tz / 100},
+        }
+    # the temperature saturates to the int16 minimum when there is none
+    if temp != -32768:
+        readings["temp"] = temp / 100
+
+    return {
+        **readings,
+        "thresTemp": thres / 100,
+        "env": env,
+        **({"agg": agg} if agg is not None else {}),
+        "device_time_ms": time_ms,
+        "format": f"bin{version}",
+        **stamp,
+    }
+
+
+IMU_MAGIC = b"MB"
+TYPE_IMU_BATCH = 2
+
+# version 1: sequence, t0, period, accel fsr, gyro fsr, count, first sample (6 x int16)
+_IMU_HEADER_V1 = struct.Struct("<HIBBBH6h")
+
+
+def is_imu_batch(payload: bytes) -> bool:
+    return len(payload) >= 4 and payload[:2] == IMU_MAGIC
+
+
+def _read_varint(data: bytes, offset: int):
+    value = shift = 0
+    while True:
+        if offset >= len(data) or shift > 21:
+            raise TelemetryDecodeError("truncated varint")
+        byte = data[offset]
+        offset += 1
+        value |= (byte & 0x7F) << shift
+        if not byte & 0x80:
+            return value, offset
+        shift += 7
+
+
+def decode_imu_batch(payload: bytes) -> dict:
+    """Full-rate MPU6050 batch (device/ImuBatch.h). Samples are raw counts: ax ay az gx gy gz."""
+    if not is_imu_batch(payload):
+        raise TelemetryDecodeError("not an IMU batch")
+    if len(payload) < 4 + _IMU_HEADER_V1.size + 2:
+        raise TelemetryDecodeError("batch too short")
+
+    body, (crc,) = payload[:-2], struct.unpack("<H", payload[-2:])
+    if crc16_ccitt(body) != crc:
+        raise TelemetryDecodeError("CRC mismatch")
+
+    version, typ = body[2], body[3]
+    if version != 1 or typ != TYPE_IMU_BATCH:
+        raise TelemetryDecodeError(f"unsupported batch version {version} type {typ}")
+
+    seq, t0, period, accel_fsr, gyro_fsr, count, *first = _IMU_HEADER_V1.unpack_from(body, 4)
+    offset = 4 + _IMU_HEADER_V1.size
+
+    samples = [first]
+    prev = list(first)
+    for _ in range(count - 1):
+        for axis in range(6):
+            zz, offset = _read_varint(body, offset)
+            delta = (zz >> 1) ^ -(zz & 1)
+            # the device works in int16, wrap the same way
+            prev[axis] = ((prev[axis] + delta + 0x8000) & 0xFFFF) - 0x8000
+        samples.append(list(prev))
+    if offset != len(body):
+        raise TelemetryDecodeError("trailing bytes after last sample")
+
+    return {
+        "type": "imu_batch",
+        "seq": seq,
+        "device_time_ms": t0,
+        "period_ms": period,
+        "accel_range_g": 2 << accel_fsr,
+        "gyro_range_dps": 250 << gyro_fsr,
+        "samples": samples,
+        "format": f"imu{version}",
+    }
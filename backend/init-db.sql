@@ -13,6 +13,14 @@ CREATE TABLE IF NOT EXISTS sensor_readings (
     ts TIMESTAMP DEFAULT CURRENT_TIMESTAMP
 );
 
+CREATE TABLE IF NOT EXISTS imu_batches (
+    id SERIAL PRIMARY KEY,
+    device_id TEXT,
+    seq INTEGER,
+    payload JSONB,
+    ts TIMESTAMP DEFAULT CURRENT_TIMESTAMP
+);
+
 CREATE TABLE IF NOT EXISTS alerts (
     id SERIAL PRIMARY KEY,
     device_id TEXT,
@@ -23,3 +31,4 @@ CREATE TABLE IF NOT EXISTS alerts (
 
 ALTER TABLE sensor_readings OWNER TO postgres;
 ALTER TABLE alerts OWNER TO postgres;
+ALTER TABLE imu_batches OWNER TO postgres;
@@ -0,0 +1,126 @@
+#include "BoardScan.h"
+#include <I2cBus.h>
+#include <AccelAndGyro.h>
+#include <BarometricPressure.h>
+#include <TempAndHumidity.h>
+#include <AirQuality.h>
+#include <LightProximityAndGesture.h>
+#include <esp_timer.h>
+
+#define MPU6050_WHO_AM_I      0x68u   /* whatever AD0 is strapped to */
+#define Si7021_USER_RESERVED  0x3Au   /* user register bits that are reserved and read as 1 */
+
+/* indexed by BoardId */
+static const boardSpec_t specs[BOARD_COUNT] =
+{
+  { "imu",      { MPU6050_ADDRESS_AD0_HIGH, MPU6050_ADDRESS_AD0_LOW }, MPU6050_WHO_AM_I_REG, MPU_WHO_AM_I_MSK,
+                { MPU6050_WHO_AM_I } },
+  { "baro",     { BMP180_I2C_ADDRESS },   CHIP_ID_REG,           0xFFu,                 { BMP180_CHIP_ID } },
+  { "humidity", { Si7021_I2C_ADDRESS },   Si7021_READ_USER_REG,  Si7021_USER_RESERVED,  { Si7021_USER_RESERVED } },
+  /* the driver only talks to 0x5A */
+  { "air",      { CCS811_I2C_ADDRESS0 },  CCS811_HW_ID_REG,      0xFFu,                 { CCS811_HW_ID } },
+  { "light",    { APDS9960_I2C_ADDRESS }, APDS9960_ID,           0xFFu,                 { APDS9960_ID_1, APDS9960_ID_2, APDS9960_ID_3 } },
+};
+
+/**
+ *
+ */
+BoardScan::BoardScan()
+{
+  for(uint8_t b = 0u; b < BOARD_COUNT; b++)
+  {
+    _state[b] = BOARD_ABSENT;
+    _address[b] = 0u;
+    _id[b] = 0u;
+  }
+  _scanUs = 0u;
+}
+
+/**
+ *
+ */
+uint8_t BoardScan::scan(void)
+{
+  uint32_t t0 = (uint32_t)esp_timer_get_time();
+  uint8_t found = 0u;
+  for(uint8_t b = 0u; b < BOARD_COUNT; b++)
+  {
+    identify((BoardId)b);
+    if(_state[b] == BOARD_FOUND)
+    {
+      found++;
+    }
+  }
+  _scanUs = (uint32_t)esp_timer_get_time() - t0;
+  return found;
+}
+
+/**
+ *   @brief tries each address in turn; the first one with a matching ID wins, an
+ *          address that answers with a wrong ID is remembered but the search goes on
+ */
+void BoardScan::identify(BoardId b)
+{
+  const boardSpec_t &spec = specs[b];
+  _state[b] = BOARD_ABSENT;
+  for(uint8_t a = 0u; (a < BOARD_MAX_ADDRESSES) && (spec.addresses[a] != 0u); a++)
+  {
+    uint8_t value;
+    if(I2cBus::shared().peek(spec.addresses[a], spec.idReg, &value) != I2C_RESULT_OK)
+    {
+      continue;
+    }
+    _address[b] = spec.addresses[a];
+    _id[b] = value;
+    _state[b] = BOARD_WRONG_ID;
+    for(uint8_t n = 0u; (n < BOARD_MAX_IDS) && (spec.ids[n] != 0u); n++)
+    {
+      if((value & spec.idMask) == spec.ids[n])
+      {
+        _state[b] = BOARD_FOUND;
+        return;
+      }
+    }
+  }
+}
+
+/**
+ *
+ */
+bool BoardScan::started(BoardId b, bool ok)
+{
+  if(found(b))
+  {
+    _state[b] = ok ? BOARD_READY : BOARD_INIT_FAILED;
+  }
+  return ok && found(b);
+}
+
+/**
+ *
+ */
+const char *BoardScan::name(BoardId b) const
+{
+  return specs[b].name;
+}
+
+/**
+ *
+ */
+const char *BoardScan::stateName(BoardState s)
+{
+  switch(s)
+  {
+    case BOARD_ABSENT:
+      return "absent";
+    case BOARD_WRONG_ID:
+      return "wrong_id";
+    case BOARD_FOUND:
+      return "found";
+    case BOARD_INIT_FAILED:
+      return "init_failed";
+    case BOARD_READY:
+      return "ready";
+  }
+  return "unknown";
+}
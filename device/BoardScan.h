@@ -0,0 +1,84 @@
+/*
+  Boot-time discovery of the MYOSA boards on the I2C bus.
+
+  Each known board is looked for at its address(es) and identified by
+  one register read: MPU6050 WHO_AM_I, BMP180 chip ID, CCS811 HW_ID,
+  APDS9960 ID. The Si7021 has no ID register that a plain register read
+  reaches, so its user register stands in: the reserved bits read back
+  as set.
+
+  setup() creates and starts a driver only for a board that was
+  identified, and reports the outcome back with started(). The result
+  per board goes into the status message, so a missing or broken board
+  is visible from the backend instead of keeping the device in a boot
+  loop.
+*/
+
+#ifndef __BOARDSCAN_H__
+#define __BOARDSCAN_H__
+
+#include <stdint.h>
+#include <Arduino.h>
+
+enum BoardId : uint8_t
+{
+  BOARD_IMU,          /* MPU6050 */
+  BOARD_BARO,         /* BMP180 */
+  BOARD_HUMIDITY,     /* Si7021 */
+  BOARD_AIR,          /* CCS811 */
+  BOARD_LIGHT,        /* APDS9960 */
+  BOARD_COUNT
+};
+
+enum BoardState : uint8_t
+{
+  BOARD_ABSENT,       /* no acknowledge at any of its addresses */
+  BOARD_WRONG_ID,     /* something answered, but not this chip */
+  BOARD_FOUND,        /* identified, driver not started yet */
+  BOARD_INIT_FAILED,  /* identified, begin() failed */
+  BOARD_READY
+};
+
+#define BOARD_MAX_ADDRESSES   2u
+#define BOARD_MAX_IDS         3u
+
+/*!
+ * Where a board lives and what it answers; 0 ends the address and ID lists
+ */
+typedef struct
+{
+  const char *name;
+  uint8_t addresses[BOARD_MAX_ADDRESSES];
+  uint8_t idReg;
+  uint8_t idMask;
+  uint8_t ids[BOARD_MAX_IDS];
+}boardSpec_t;
+
+class BoardScan
+{
+  public:
+    BoardScan();
+    /* look for every known board, returns how many were identified */
+    uint8_t scan(void);
+    /* identified by the scan: a driver may be created */
+    bool found(BoardId b) const { return _state[b] >= BOARD_FOUND; }
+    bool ready(BoardId b) const { return _state[b] == BOARD_READY; }
+    /* the address it answered at */
+    uint8_t address(BoardId b) const { return _address[b]; }
+    uint8_t id(BoardId b) const { return _id[b]; }
+    /* outcome of the driver's begin(); returns ok */
+    bool started(BoardId b, bool ok);
+    BoardState state(BoardId b) const { return _state[b]; }
+    const char *name(BoardId b) const;
+    static const char *stateName(BoardState s);
+    uint32_t scanUs(void) const { return _scanUs; }
+  private:
+    BoardState _state[BOARD_COUNT];
+    uint8_t _address[BOARD_COUNT];
+    uint8_t _id[BOARD_COUNT];
+    uint32_t _scanUs;
+
+    void identify(BoardId b);
+};
+
+#endif
@@ -0,0 +1,261 @@
+#include "ConfigStore.h"
+#include <string.h>
+
+/**
+ *
+ */
+ConfigStore::ConfigStore(const char *nvsNamespace)
+{
+  _namespace  = nvsNamespace;
+  _handle     = 0u;
+  _open       = false;
+  _count      = 0u;
+  _dirtySince = 0u;
+  _lastCommit = 0u;
+  _committed  = false;
+  _commits    = 0u;
+  _writes     = 0u;
+  _coalesced  = 0u;
+}
+
+/**
+ *
+ */
+bool ConfigStore::addFloat(const char *key, volatile float *value)
+{
+  return add(key, CONFIG_FLOAT, value);
+}
+
+/**
+ *
+ */
+bool ConfigStore::addU32(const char *key, volatile uint32_t *value)
+{
+  return add(key, CONFIG_U32, value);
+}
+
+/**
+ *
+ */
+bool ConfigStore::add(const char *key, ConfigType type, volatile void *value)
+{
+  if((_count >= CONFIG_MAX_KEYS) || (find(key) != NULL))
+  {
+    return false;
+  }
+  entry_t &e = _entries[_count++];
+  e.key   = key;
+  e.type  = type;
+  if(type == CONFIG_FLOAT)
+  {
+    e.ram.f = (volatile float *)value;
+  }
+  else
+  {
+    e.ram.u = (volatile uint32_t *)value;
+  }
+  e.stored = ramBits(e);
+  e.dirty  = false;
+  return true;
+}
+
+/**
+ *   @brief missing keys keep their RAM default and are not written until changed
+ */
+bool ConfigStore::begin(void)
+{
+  if(nvs_open(_namespace, NVS_READWRITE, &_handle) != ESP_OK)
+  {
+    return false;
+  }
+  _open = true;
+  for(uint8_t n = 0u; n < _count; n++)
+  {
+    entry_t &e = _entries[n];
+    if(e.type == CONFIG_FLOAT)
+    {
+      float f;
+      size_t len = sizeof(f);
+      if((nvs_get_blob(_handle, e.key, &f, &len) == ESP_OK) && (len == sizeof(f)))
+      {
+        *e.ram.f = f;
+      }
+    }
+    else
+    {
+      uint32_t u;
+      if(nvs_get_u32(_handle, e.key, &u) == ESP_OK)
+      {
+        *e.ram.u = u;
+      }
+    }
+    e.stored = ramBits(e);
+  }
+  return true;
+}
+
+/**
+ *
+ */
+bool ConfigStore::setFloat(const char *key, float value)
+{
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return set(key, CONFIG_FLOAT, bits);
+}
+
+/**
+ *
+ */
+bool ConfigStore::setU32(const char *key, uint32_t value)
+{
+  return set(key, CONFIG_U32, value);
+}
+
+/**
+ *
+ */
+bool ConfigStore::set(const char *key, ConfigType type, uint32_t bits)
+{
+  entry_t *e = find(key);
+  if((e == NULL) || (e->type != type))
+  {
+    return false;
+  }
+  if(e->type == CONFIG_FLOAT)
+  {
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    *e->ram.f = f;
+  }
+  else
+  {
+    *e->ram.u = bits;
+  }
+
+  bool dirty = (bits != e->stored);
+  if(dirty && e->dirty)
+  {
+    _coalesced++;
+  }
+  if(dirty && (pending() == 0u))
+  {
+    _dirtySince = millis();
+  }
+  e->dirty = dirty;
+  return true;
+}
+
+/**
+ *
+ */
+void ConfigStore::loop(unsigned long now)
+{
+  if(pending() == 0u)
+  {
+    return;
+  }
+  if((now - _dirtySince) < CONFIG_COMMIT_DELAY)
+  {
+    return;
+  }
+  if(_committed && ((now - _lastCommit) < CONFIG_MIN_COMMIT_GAP))
+  {
+    return;
+  }
+  flush();
+}
+
+/**
+ *   @brief one NVS write per changed key, one commit for all of them
+ */
+bool ConfigStore::flush(void)
+{
+  if((_open == false) || (pending() == 0u))
+  {
+    return _open;
+  }
+  bool ok = true;
+  for(uint8_t n = 0u; n < _count; n++)
+  {
+    entry_t &e = _entries[n];
+    if(e.dirty == false)
+    {
+      continue;
+    }
+    uint32_t bits = ramBits(e);
+    esp_err_t err;
+    if(e.type == CONFIG_FLOAT)
+    {
+      err = nvs_set_blob(_handle, e.key, &bits, sizeof(bits));
+    }
+    else
+    {
+      err = nvs_set_u32(_handle, e.key, bits);
+    }
+    if(err != ESP_OK)
+    {
+      ok = false;
+      continue;
+    }
+    e.stored = bits;
+    e.dirty  = false;
+    _writes++;
+  }
+  if(nvs_commit(_handle) != ESP_OK)
+  {
+    ok = false;
+  }
+  _commits++;
+  _committed  = true;
+  _lastCommit = millis();
+  /* anything that failed is retried after the next delay */
+  _dirtySince = _lastCommit;
+  return ok;
+}
+
+/**
+ *
+ */
+uint8_t ConfigStore::pending(void) const
+{
+  uint8_t dirty = 0u;
+  for(uint8_t n = 0u; n < _count; n++)
+  {
+    if(_entries[n].dirty)
+    {
+      dirty++;
+    }
+  }
+  return dirty;
+}
+
+/**
+ *
+ */
+ConfigStore::entry_t *ConfigStore::find(const char *key)
+{
+  for(uint8_t n = 0u; n < _count; n++)
+  {
+    if(strcmp(_entries[n].key, key) == 0)
+    {
+      return &_entries[n];
+    }
+  }
+  return NULL;
+}
+
+/**
+ *
+ */
+uint32_t ConfigStore::ramBits(const entry_t &e) const
+{
+  if(e.type == CONFIG_FLOAT)
+  {
+    float f = *e.ram.f;
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return bits;
+  }
+  return *e.ram.u;
+}
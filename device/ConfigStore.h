@@ -0,0 +1,85 @@
+/*
+  Deferred, coalesced persistence for runtime configuration.
+
+  Each setting is registered once with the RAM variable the firmware
+  actually reads. A set*() from a command updates that variable at once and
+  only marks the entry dirty; loop() later writes every dirty entry in one
+  NVS pass with a single commit. Repeated changes to a key between commits
+  cost one flash write, and a value set back to what is already stored
+  costs none.
+
+  Flash writes stall the cache on both cores, so loop() and flush() belong
+  on the network task and are rate limited; the sensing task only ever
+  reads the RAM copies. Call flush() before deep sleep or a restart.
+*/
+
+#ifndef __CONFIGSTORE_H__
+#define __CONFIGSTORE_H__
+
+#include <stdint.h>
+#include <Arduino.h>
+#include <nvs.h>
+
+#define CONFIG_MAX_KEYS         24u
+#define CONFIG_COMMIT_DELAY     5000u     /* ms a change waits for more changes to join it */
+#define CONFIG_MIN_COMMIT_GAP   60000u    /* ms at least between two commits, so a stream of changes cannot wear the NVS flash */
+
+enum ConfigType : uint8_t
+{
+  CONFIG_FLOAT,     /* stored as a 4 byte blob, same layout as Preferences::putFloat() */
+  CONFIG_U32
+};
+
+class ConfigStore
+{
+  public:
+    ConfigStore(const char *nvsNamespace);
+    /* register a setting before begin(); key is an NVS key, at most 15 characters */
+    bool addFloat(const char *key, volatile float *value);
+    bool addU32(const char *key, volatile uint32_t *value);
+    /* open the namespace and load every stored key over the RAM defaults */
+    bool begin(void);
+    /* apply in RAM now, persist later; false for an unknown key */
+    bool setFloat(const char *key, float value);
+    bool setU32(const char *key, uint32_t value);
+    /* commit pending changes once they have settled, call periodically */
+    void loop(unsigned long now);
+    /* commit pending changes now */
+    bool flush(void);
+    uint8_t pending(void) const;
+    uint32_t commits(void) const { return _commits; }
+    uint32_t writes(void) const { return _writes; }
+    uint32_t coalesced(void) const { return _coalesced; }
+  private:
+    typedef struct
+    {
+      const char *key;
+      ConfigType type;
+      union
+      {
+        volatile float *f;
+        volatile uint32_t *u;
+      } ram;
+      uint32_t stored;          /* bit pattern last read from or written to NVS */
+      bool dirty;
+    } entry_t;
+
+    const char *_namespace;
+    nvs_handle_t _handle;
+    bool _open;
+    entry_t _entries[CONFIG_MAX_KEYS];
+    uint8_t _count;
+    unsigned long _dirtySince;
+    unsigned long _lastCommit;
+    bool _committed;
+    uint32_t _commits;
+    uint32_t _writes;
+    uint32_t _coalesced;
+
+    entry_t *find(const char *key);
+    bool add(const char *key, ConfigType type, volatile void *value);
+    bool set(const char *key, ConfigType type, uint32_t bits);
+    uint32_t ramBits(const entry_t &e) const;
+};
+
+#endif
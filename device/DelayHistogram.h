@@ -0,0 +1,48 @@
+/*
+  Log2 histogram of message queueing delay, sample to publish, in ms.
+
+  Bucket 0 counts delays under 1 ms, bucket n those from 2^(n-1) up to
+  2^n ms and the last one everything from 2^(DELAY_BUCKETS-2) ms (about
+  33 s) up. Written and read by the network task only.
+*/
+
+#ifndef __DELAYHISTOGRAM_H__
+#define __DELAYHISTOGRAM_H__
+
+#include <stdint.h>
+
+#define DELAY_BUCKETS   17u
+
+struct DelayHistogram
+{
+  uint32_t bucket[DELAY_BUCKETS];
+  uint32_t count;
+  uint32_t maxMs;
+
+  void add(uint32_t ms)
+  {
+    uint8_t n = 0u;
+    while((n < DELAY_BUCKETS - 1u) && (ms >= (1UL << n)))
+    {
+      n++;
+    }
+    bucket[n]++;
+    count++;
+    if(ms > maxMs)
+    {
+      maxMs = ms;
+    }
+  }
+
+  void reset(void)
+  {
+    for(uint8_t n = 0u; n < DELAY_BUCKETS; n++)
+    {
+      bucket[n] = 0u;
+    }
+    count = 0u;
+    maxMs = 0u;
+  }
+};
+
+#endif
@@ -0,0 +1,103 @@
+#include "DetectionConfig.h"
+
+/* x inside [lo, hi]; false for NaN */
+static bool inRange(float x, float lo, float hi)
+{
+  return (x >= lo) && (x <= hi);
+}
+
+/**
+ *
+ */
+DetectionConfig::DetectionConfig(const detectionParams_t &defaults)
+  : _active(0u), _pending(false)
+{
+  _buf[0] = defaults;
+  _buf[1] = defaults;
+  _latest = 0u;
+  _switches = 0u;
+}
+
+/**
+ *   @brief limits are what the sensors and the sensing loop can honour, not tuning advice
+ */
+const char *DetectionConfig::validate(const detectionParams_t &p)
+{
+  if(!inRange(p.impactG, 0.1f, 16.f))
+  {
+    return "impact_g";
+  }
+  if(!inRange(p.impactSlopeG, 0.f, 16.f))
+  {
+    return "impact_slope_g";
+  }
+  if(!inRange(p.gyroSpike, 1.f, 2000.f))
+  {
+    return "gyro_spike";
+  }
+  if((p.fallCooldownMs < 100u) || (p.fallCooldownMs > 600000u))
+  {
+    return "fall_cooldown_ms";
+  }
+  if(!inRange(p.alpha, 0.001f, 1.f))
+  {
+    return "alpha";
+  }
+  if((p.sensorIntervalMs < DETECTION_INTERVAL_MIN_MS) || (p.sensorIntervalMs > DETECTION_INTERVAL_MAX_MS))
+  {
+    return "sensor_interval_ms";
+  }
+  if(!inRange(p.tempThreshold, 0.f, 60.f))
+  {
+    return "temp_threshold";
+  }
+
+  const publishParams_t &pub = p.publish;
+  if((pub.minMs < PUBLISH_MIN_FLOOR_MS) || (pub.activeMs < PUBLISH_MIN_FLOOR_MS))
+  {
+    return "publish";
+  }
+  if((pub.heartbeatMs < pub.minMs) || (pub.heartbeatMs < pub.activeMs))
+  {
+    return "publish.heartbeat_ms";
+  }
+  for(uint8_t n = 0u; n < DB_COUNT; n++)
+  {
+    if(!(pub.deadband[n] >= 0.f))
+    {
+      return "publish.deadband";
+    }
+  }
+  return NULL;
+}
+
+/**
+ *   @brief only the spare buffer is written, the sensing task never reads it until apply()
+ */
+bool DetectionConfig::stage(const detectionParams_t &p)
+{
+  if(_pending.load(std::memory_order_acquire))
+  {
+    return false;
+  }
+  uint8_t spare = _active.load(std::memory_order_relaxed) ^ 1u;
+  _buf[spare] = p;
+  _latest = spare;
+  _pending.store(true, std::memory_order_release);
+  return true;
+}
+
+/**
+ *
+ */
+bool DetectionConfig::apply(void)
+{
+  if(!_pending.load(std::memory_order_acquire))
+  {
+    return false;
+  }
+  _active.store(_active.load(std::memory_order_relaxed) ^ 1u, std::memory_order_relaxed);
+  _switches++;
+  _pending.store(false, std::memory_order_release);
+  return true;
+}
@@ -0,0 +1,90 @@
+/*
+  Versioned, double-buffered runtime configuration of the sensing path.
+
+  Detector thresholds, the filter constant, the IMU sample interval and the
+  telemetry policy used to be compile-time constants. They now live in one
+  parameter set that the network task fills from a config command:
+
+    {"config":{"schema":1,"version":N, "impact_g":..,"impact_slope_g":..,
+               "gyro_spike":..,"fall_cooldown_ms":..,"alpha":..,
+               "sensor_interval_ms":..,"temp_threshold":..,
+               "publish":{"min_ms":..,"active_ms":..,"heartbeat_ms":..,
+                          "deadband":{"temp":..,..}}}}
+
+  Fields left out keep their current value. The merged set is validated as
+  a whole; a valid one is written into the spare buffer and handed over.
+  The sensing task switches buffers at the start of a tick, so one sample
+  is always processed with one complete set, never half an update. A set
+  that arrives before the previous one was taken waits on the network
+  task, which stages it on a later pass; a newer set replaces it there.
+
+  version is the revision assigned by the backend (push_config in
+  backend/app/routers/devices.py). An update must carry a higher one than
+  the set in use; an equal one is a repeat of what is already applied and
+  is only acknowledged again, one without a version is rejected.
+*/
+
+#ifndef __DETECTIONCONFIG_H__
+#define __DETECTIONCONFIG_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "PublishPolicy.h"
+
+#define DETECTION_SCHEMA            1u
+#define DETECTION_INTERVAL_MIN_MS   5u      /* one MPU6050 burst plus processing */
+#define DETECTION_INTERVAL_MAX_MS   50u     /* 20 Hz, below that the impact peak is missed */
+
+/*!
+ * Telemetry policy inside a parameter set, copied into PublishPolicy::cfg on switch
+ */
+typedef struct
+{
+  uint32_t minMs;
+  uint32_t activeMs;
+  uint32_t heartbeatMs;
+  float deadband[DB_COUNT];
+}publishParams_t;
+
+/*!
+ * One complete parameter set
+ */
+typedef struct
+{
+  uint32_t version;
+  float impactG;              /**< net acceleration, g */
+  float impactSlopeG;         /**< rise of the net acceleration over the slope span, g */
+  float gyroSpike;            /**< deg/s */
+  uint32_t fallCooldownMs;
+  float alpha;                /**< low pass weight of a new accel sample, 0..1 */
+  uint32_t sensorIntervalMs;
+  float tempThreshold;        /**< degC */
+  publishParams_t publish;
+}detectionParams_t;
+
+class DetectionConfig
+{
+  public:
+    DetectionConfig(const detectionParams_t &defaults);
+    /* NULL when p can be used, else the name of the first bad field */
+    static const char *validate(const detectionParams_t &p);
+    /* network task: hand a validated set over; false while the previous one is still waiting */
+    bool stage(const detectionParams_t &p);
+    /* sensing task, between samples: switch to a staged set, true when it did */
+    bool apply(void);
+    /* sensing task: the set in use */
+    const detectionParams_t &active(void) const { return _buf[_active.load(std::memory_order_relaxed)]; }
+    /* network task: the set in use, or the one about to be */
+    const detectionParams_t &latest(void) const { return _buf[_latest]; }
+    bool pending(void) const { return _pending.load(std::memory_order_acquire); }
+    uint32_t switches(void) const { return _switches; }
+  private:
+    detectionParams_t _buf[2];
+    std::atomic<uint8_t> _active;
+    std::atomic<bool> _pending;   /* spare buffer holds a set the sensing task has not taken yet */
+    uint8_t _latest;              /* network task: buffer written last */
+    uint32_t _switches;
+};
+
+#endif
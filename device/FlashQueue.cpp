@@ -0,0 +1,317 @@
+#include "FlashQueue.h"
+#include "TelemetryCodec.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ *
+ */
+FlashQueue::FlashQueue(const char *dir, uint16_t maxSegments, uint16_t segmentBytes)
+{
+  _dir             = dir;
+  _maxSegments     = (maxSegments < 2u) ? 2u : maxSegments;
+  _segmentBytes    = segmentBytes;
+  _ready           = false;
+  _headSeg         = 0u;
+  _headSize        = 0u;
+  _tailSeg         = 0u;
+  _tailOff         = 0u;
+  _headOpen        = false;
+  _appended        = 0u;
+  _drained         = 0u;
+  _dropped         = 0u;
+  _droppedSegments = 0u;
+  _corrupt         = 0u;
+}
+
+/**
+ *   @brief segments are named s<hex number>, the read cursor lives in "cur"
+ */
+bool FlashQueue::begin(void)
+{
+  if((LittleFS.exists(_dir) == false) && (LittleFS.mkdir(_dir) == false))
+  {
+    return false;
+  }
+  File dir = LittleFS.open(_dir);
+  if(!dir)
+  {
+    return false;
+  }
+
+  bool found = false;
+  uint32_t minSeg = 0u;
+  uint32_t maxSeg = 0u;
+  for(File f = dir.openNextFile(); f; f = dir.openNextFile())
+  {
+    /* older cores return the full path, newer ones the base name */
+    const char *name = strrchr(f.name(), '/');
+    name = (name != NULL) ? (name + 1) : f.name();
+    f.close();
+    if(name[0] != 's')
+    {
+      continue;
+    }
+    uint32_t seg = strtoul(name + 1, NULL, 16);
+    if((found == false) || (seg < minSeg)) minSeg = seg;
+    if((found == false) || (seg > maxSeg)) maxSeg = seg;
+    found = true;
+  }
+  dir.close();
+
+  uint32_t seg, off;
+  bool haveCursor = loadCursor(seg, off);
+  if(found)
+  {
+    _headSeg = maxSeg + 1u;
+    if(haveCursor && (seg >= minSeg) && (seg <= maxSeg))
+    {
+      _tailSeg = seg;
+      _tailOff = off;
+    }
+    else
+    {
+      _tailSeg = minSeg;
+      _tailOff = 0u;
+    }
+  }
+  else
+  {
+    _headSeg = haveCursor ? (seg + 1u) : 0u;
+    _tailSeg = _headSeg;
+    _tailOff = 0u;
+  }
+  _headSize = 0u;
+  _ready = true;
+  return true;
+}
+
+/**
+ *   @brief flushed per record, so at most the record being written is lost on a reset
+ */
+bool FlashQueue::push(const uint8_t *data, uint16_t len)
+{
+  if((_ready == false) || (len == 0u) || (FLASHQ_HEADER + len > _segmentBytes))
+  {
+    _dropped++;
+    return false;
+  }
+
+  if(_headSize + FLASHQ_HEADER + len > _segmentBytes)
+  {
+    if(_headOpen)
+    {
+      _head.close();
+      _headOpen = false;
+    }
+    _headSeg++;
+    _headSize = 0u;
+  }
+  while(_headSeg - _tailSeg + 1u > _maxSegments)
+  {
+    removeTail();
+    _droppedSegments++;
+  }
+
+  if(_headOpen == false)
+  {
+    char path[FLASHQ_PATH_MAX];
+    segmentPath(_headSeg, path);
+    _head = LittleFS.open(path, "a");
+    if(!_head)
+    {
+      _dropped++;
+      return false;
+    }
+    _headOpen = true;
+  }
+
+  uint8_t header[FLASHQ_HEADER];
+  uint16_t crc = telemetryCrc16(data, len);
+  header[0] = FLASHQ_MAGIC;
+  header[1] = 0u;
+  header[2] = (uint8_t)(len & 0xFFu);
+  header[3] = (uint8_t)(len >> 8);
+  header[4] = (uint8_t)(crc & 0xFFu);
+  header[5] = (uint8_t)(crc >> 8);
+
+  size_t written = _head.write(header, FLASHQ_HEADER);
+  written += _head.write(data, len);
+  _head.flush();
+  _headSize += written;
+  if(written != FLASHQ_HEADER + len)
+  {
+    /* the reader stops at the torn record, so later ones go to a fresh segment */
+    _head.close();
+    _headOpen = false;
+    _headSeg++;
+    _headSize = 0u;
+    _dropped++;
+    return false;
+  }
+  _appended++;
+  return true;
+}
+
+/**
+ *   @brief stops at the first failed send, an empty queue or after maxRecords
+ */
+uint16_t FlashQueue::drain(uint16_t maxRecords, flashQueueSend_t send, void *ctx, uint8_t *buf, uint16_t cap)
+{
+  uint16_t sent = 0u;
+  bool moved = false;
+  File f;
+  bool open = false;
+
+  while((sent < maxRecords) && (empty() == false))
+  {
+    if(open == false)
+    {
+      char path[FLASHQ_PATH_MAX];
+      segmentPath(_tailSeg, path);
+      f = LittleFS.open(path, "r");
+      open = (bool)f;
+      if(open)
+      {
+        f.seek(_tailOff);
+      }
+    }
+
+    uint8_t header[FLASHQ_HEADER];
+    uint16_t len = 0u;
+    bool valid = open && (f.read(header, FLASHQ_HEADER) == FLASHQ_HEADER);
+    if(valid)
+    {
+      len = (uint16_t)header[2] | ((uint16_t)header[3] << 8);
+      uint16_t crc = (uint16_t)header[4] | ((uint16_t)header[5] << 8);
+      valid = (header[0] == FLASHQ_MAGIC) && (len > 0u) && (len <= cap) &&
+              (f.read(buf, len) == len) && (telemetryCrc16(buf, len) == crc);
+      if(valid == false)
+      {
+        _corrupt++;
+      }
+    }
+
+    if(valid == false)
+    {
+      /* end of the segment, or a torn record: nothing after it can be trusted */
+      if(open)
+      {
+        f.close();
+        open = false;
+      }
+      if(_tailSeg == _headSeg)
+      {
+        _tailOff = _headSize;
+      }
+      else
+      {
+        removeTail();
+      }
+      moved = true;
+      continue;
+    }
+
+    if(send(buf, len, ctx) == false)
+    {
+      break;
+    }
+    _tailOff += FLASHQ_HEADER + len;
+    _drained++;
+    sent++;
+    moved = true;
+  }
+
+  if(open)
+  {
+    f.close();
+  }
+  if(moved)
+  {
+    saveCursor();
+  }
+  return sent;
+}
+
+/**
+ *
+ */
+bool FlashQueue::empty(void) const
+{
+  return (_ready == false) || ((_tailSeg == _headSeg) && (_tailOff >= _headSize));
+}
+
+/**
+ *
+ */
+void FlashQueue::segmentPath(uint32_t seg, char *path) const
+{
+  snprintf(path, FLASHQ_PATH_MAX, "%s/s%08lx", _dir, (unsigned long)seg);
+}
+
+/**
+ *
+ */
+void FlashQueue::cursorPath(char *path) const
+{
+  snprintf(path, FLASHQ_PATH_MAX, "%s/cur", _dir);
+}
+
+/**
+ *   @brief cursor file: u32 segment, u32 offset, u16 CRC over both
+ */
+bool FlashQueue::loadCursor(uint32_t &seg, uint32_t &off)
+{
+  char path[FLASHQ_PATH_MAX];
+  cursorPath(path);
+  File f = LittleFS.open(path, "r");
+  if(!f)
+  {
+    return false;
+  }
+  uint8_t data[10];
+  bool ok = (f.read(data, sizeof(data)) == sizeof(data)) &&
+            (telemetryCrc16(data, 8u) == ((uint16_t)data[8] | ((uint16_t)data[9] << 8)));
+  f.close();
+  if(ok)
+  {
+    memcpy(&seg, &data[0], sizeof(seg));
+    memcpy(&off, &data[4], sizeof(off));
+  }
+  return ok;
+}
+
+/**
+ *
+ */
+void FlashQueue::saveCursor(void)
+{
+  char path[FLASHQ_PATH_MAX];
+  cursorPath(path);
+  File f = LittleFS.open(path, "w");
+  if(!f)
+  {
+    return;
+  }
+  uint8_t data[10];
+  memcpy(&data[0], &_tailSeg, sizeof(_tailSeg));
+  memcpy(&data[4], &_tailOff, sizeof(_tailOff));
+  uint16_t crc = telemetryCrc16(data, 8u);
+  data[8] = (uint8_t)(crc & 0xFFu);
+  data[9] = (uint8_t)(crc >> 8);
+  f.write(data, sizeof(data));
+  f.close();
+}
+
+/**
+ *   @brief never called on the head segment
+ */
+void FlashQueue::removeTail(void)
+{
+  char path[FLASHQ_PATH_MAX];
+  segmentPath(_tailSeg, path);
+  LittleFS.remove(path);
+  _tailSeg++;
+  _tailOff = 0u;
+}
@@ -0,0 +1,89 @@
+/*
+  Persistent store-and-forward queue on LittleFS.
+
+  Messages that cannot be published (link down, or the RAM queue backing
+  up) are appended to a ring of fixed-size segment files in one directory.
+  Each record carries its length and a CRC, so a record torn by a reset
+  is detected and skipped instead of being published as garbage. drain()
+  publishes the oldest records in batches and persists the read cursor
+  once per batch; a fully read segment is deleted.
+
+  Appends rotate through new segment files instead of rewriting one, and
+  LittleFS spreads the blocks underneath over the whole partition, so the
+  flash wears evenly. When the ring is full the oldest segment is dropped
+  and counted.
+
+  After a reset appends always start a new segment, so a torn tail is only
+  ever found at the end of a segment that is no longer written.
+
+  All calls belong on the network task. A block erase (about once every
+  4 KB appended) stalls the cache on both cores for tens of ms; the sensing
+  task catches up on its vTaskDelayUntil schedule.
+
+  Record layout (little endian):
+
+    0   u8   FLASHQ_MAGIC
+    1   u8   reserved, 0
+    2   u16  payload length
+    4   u16  CRC-16/CCITT-FALSE over the payload
+    6   payload
+*/
+
+#ifndef __FLASHQUEUE_H__
+#define __FLASHQUEUE_H__
+
+#include <stdint.h>
+#include <Arduino.h>
+#include <LittleFS.h>
+
+#define FLASHQ_MAGIC          0x5Au
+#define FLASHQ_HEADER         6u
+#define FLASHQ_PATH_MAX       24u
+
+/* publish one stored payload; false leaves it queued and ends the drain */
+typedef bool (*flashQueueSend_t)(const uint8_t *data, uint16_t len, void *ctx);
+
+class FlashQueue
+{
+  public:
+    /* dir: e.g. "/qa", at most 12 characters; LittleFS must be mounted before begin() */
+    FlashQueue(const char *dir, uint16_t maxSegments, uint16_t segmentBytes);
+    /* find the segments left by the previous run and the saved read cursor */
+    bool begin(void);
+    /* append one payload; false when it cannot be stored */
+    bool push(const uint8_t *data, uint16_t len);
+    /* send up to maxRecords of the oldest payloads through buf, returns how many went out */
+    uint16_t drain(uint16_t maxRecords, flashQueueSend_t send, void *ctx, uint8_t *buf, uint16_t cap);
+    bool empty(void) const;
+    bool ready(void) const { return _ready; }
+    uint32_t segments(void) const { return _ready ? (_headSeg - _tailSeg + 1u) : 0u; }
+    uint32_t appended(void) const { return _appended; }
+    uint32_t drained(void) const { return _drained; }
+    uint32_t dropped(void) const { return _dropped; }
+    uint32_t droppedSegments(void) const { return _droppedSegments; }
+    uint32_t corrupt(void) const { return _corrupt; }
+  private:
+    const char *_dir;
+    uint16_t _maxSegments;
+    uint16_t _segmentBytes;
+    bool _ready;
+    uint32_t _headSeg;          /* segment appended to */
+    uint32_t _headSize;
+    uint32_t _tailSeg;          /* segment read from */
+    uint32_t _tailOff;
+    File _head;
+    bool _headOpen;
+    uint32_t _appended;
+    uint32_t _drained;
+    uint32_t _dropped;          /* payloads refused: too long or the file system failed */
+    uint32_t _droppedSegments;  /* oldest segments given up to make room */
+    uint32_t _corrupt;
+
+    void segmentPath(uint32_t seg, char *path) const;
+    void cursorPath(char *path) const;
+    bool loadCursor(uint32_t &seg, uint32_t &off);
+    void saveCursor(void);
+    void removeTail(void);
+};
+
+#endif
@@ -0,0 +1,166 @@
+#include "I2cQueue.h"
+#include <I2cBus.h>
+#include <esp_timer.h>
+
+/**
+ *
+ */
+I2cQueue::I2cQueue()
+{
+  _queue     = NULL;
+  _task      = NULL;
+  _completed = 0u;
+  _failed    = 0u;
+  _rejected  = 0u;
+  _busUs     = 0u;
+}
+
+/**
+ *
+ */
+bool I2cQueue::begin(BaseType_t core, UBaseType_t priority, uint32_t stackBytes)
+{
+  _queue = xQueueCreate(I2C_QUEUE_DEPTH, sizeof(I2cTransfer *));
+  if(_queue == NULL)
+  {
+    return false;
+  }
+  return xTaskCreatePinnedToCore(taskEntry, "i2c", stackBytes, this, priority, &_task, core) == pdPASS;
+}
+
+/**
+ *
+ */
+bool I2cQueue::submit(I2cTransfer *xfer)
+{
+  if(xfer->status.load(std::memory_order_acquire) == I2C_QUEUED)
+  {
+    _rejected++;
+    return false;
+  }
+  xfer->waiter   = xTaskGetCurrentTaskHandle();
+  xfer->submitUs = (uint32_t)esp_timer_get_time();
+  xfer->status.store(I2C_QUEUED, std::memory_order_release);
+  if(xQueueSend(_queue, &xfer, 0) != pdTRUE)
+  {
+    xfer->status.store(I2C_IDLE, std::memory_order_release);
+    _rejected++;
+    return false;
+  }
+  return true;
+}
+
+/**
+ *   @brief sleeps on the task notification the bus task gives after each transfer
+ */
+bool I2cQueue::wait(I2cTransfer *xfer, uint32_t timeoutMs)
+{
+  TickType_t start = xTaskGetTickCount();
+  while(!xfer->done())
+  {
+    TickType_t waited = xTaskGetTickCount() - start;
+    if(waited >= pdMS_TO_TICKS(timeoutMs))
+    {
+      return false;
+    }
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeoutMs) - waited);
+  }
+  return true;
+}
+
+/**
+ *
+ */
+bool I2cQueue::transfer(I2cTransfer *xfer, uint32_t timeoutMs)
+{
+  return submit(xfer) && wait(xfer, timeoutMs) && xfer->ok();
+}
+
+/**
+ *
+ */
+void I2cQueue::taskEntry(void *arg)
+{
+  ((I2cQueue *)arg)->run();
+}
+
+/**
+ *
+ */
+void I2cQueue::run(void)
+{
+  I2cTransfer *xfer;
+  for(;;)
+  {
+    if(xQueueReceive(_queue, &xfer, portMAX_DELAY) != pdTRUE)
+    {
+      continue;
+    }
+    uint32_t t0 = (uint32_t)esp_timer_get_time();
+    I2cStatus status = execute(xfer);
+    xfer->durationUs = (uint32_t)esp_timer_get_time() - t0;
+    _busUs += xfer->durationUs;
+    if(status == I2C_DONE)
+    {
+      _completed++;
+    }
+    else
+    {
+      _failed++;
+    }
+    /* callback first: once status is final the submitter may reuse the transfer */
+    TaskHandle_t waiter = xfer->waiter;
+    if(xfer->onComplete != NULL)
+    {
+      xfer->onComplete(xfer, status, xfer->ctx);
+    }
+    xfer->status.store(status, std::memory_order_release);
+    if(waiter != NULL)
+    {
+      xTaskNotifyGive(waiter);
+    }
+  }
+}
+
+/* bus manager outcome in queue terms */
+static I2cStatus queueStatus(I2cResult result)
+{
+  switch(result)
+  {
+    case I2C_RESULT_OK:
+      return I2C_DONE;
+    case I2C_RESULT_SHORT_READ:
+      return I2C_SHORT_READ;
+    case I2C_RESULT_TIMEOUT:
+    case I2C_RESULT_BUS_STUCK:
+      return I2C_BUS_FAULT;
+    default:
+      return I2C_NACK;
+  }
+}
+
+/**
+ *   @brief through the shared bus, so it is serialised with the blocking driver calls and counted
+ *          against the device; the address must belong to an attached driver
+ */
+I2cStatus I2cQueue::execute(I2cTransfer *xfer)
+{
+  I2cBus &bus = I2cBus::shared();
+  int8_t dev = bus.find(xfer->address);
+  if(xfer->rxLen == 0u)
+  {
+    return queueStatus(bus.write(dev, xfer->reg, xfer->tx, xfer->txLen));
+  }
+  if(xfer->txLen == 0u)
+  {
+    return queueStatus(bus.read(dev, xfer->reg, xfer->rx, xfer->rxLen));
+  }
+  bus.lock();
+  I2cResult result = bus.write(dev, xfer->reg, xfer->tx, xfer->txLen);
+  if(result == I2C_RESULT_OK)
+  {
+    result = bus.receive(dev, xfer->rx, xfer->rxLen);
+  }
+  bus.unlock();
+  return queueStatus(result);
+}
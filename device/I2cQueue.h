@@ -0,0 +1,97 @@
+/*
+  Asynchronous I2C transactions on a dedicated bus task.
+
+  A caller fills in an I2cTransfer (device, register, bytes to write,
+  buffer to read into) and submits it; the bus task runs it on the shared
+  I2cBus and marks it done, optionally calling a completion callback on the
+  bus task.
+  While Wire waits on the I2C peripheral interrupt the bus task is blocked,
+  so the submitting task keeps the CPU and can work on the previous sample
+  in the meantime; wait() then only blocks for whatever is left of the
+  transfer.
+
+  A transfer must stay alive and untouched until done() is true. Blocking
+  driver calls from other tasks are safe meanwhile: I2cBus serialises them
+  with the queued transfers.
+*/
+
+#ifndef __I2CQUEUE_H__
+#define __I2CQUEUE_H__
+
+#include <stdint.h>
+#include <atomic>
+#include <Arduino.h>
+
+#define I2C_QUEUE_DEPTH     8u
+#define I2C_MAX_WRITE       8u      /* payload bytes after the register address */
+
+enum I2cStatus : uint8_t
+{
+  I2C_IDLE,
+  I2C_QUEUED,
+  I2C_DONE,
+  I2C_NACK,           /* address or register write not acknowledged */
+  I2C_SHORT_READ,     /* device returned fewer bytes than asked for */
+  I2C_BUS_FAULT       /* timed out or SDA stuck, after I2cBus retries and recovery */
+};
+
+struct I2cTransfer;
+typedef void (*i2cCallback_t)(I2cTransfer *xfer, I2cStatus status, void *ctx);
+
+/*!
+ * One register transaction: write reg (+ tx), then read rxLen bytes if rxLen > 0
+ */
+struct I2cTransfer
+{
+  uint8_t address;
+  uint8_t reg;
+  uint8_t tx[I2C_MAX_WRITE];
+  uint8_t txLen;
+  uint8_t *rx;
+  uint8_t rxLen;
+  i2cCallback_t onComplete;   /**< optional, runs on the bus task */
+  void *ctx;
+  uint32_t submitUs;          /**< esp_timer time of submit() */
+  uint32_t durationUs;        /**< time on the bus */
+  TaskHandle_t waiter;        /**< notified on completion, set by submit() */
+  std::atomic<uint8_t> status;
+
+  I2cTransfer() : address(0u), reg(0u), txLen(0u), rx(NULL), rxLen(0u), onComplete(NULL),
+                  ctx(NULL), submitUs(0u), durationUs(0u), waiter(NULL), status(I2C_IDLE) {}
+  void read(uint8_t addr, uint8_t startReg, uint8_t *buf, uint8_t len)
+  {
+    address = addr; reg = startReg; txLen = 0u; rx = buf; rxLen = len;
+  }
+  bool done(void) const { return status.load(std::memory_order_acquire) >= I2C_DONE; }
+  bool ok(void) const { return status.load(std::memory_order_acquire) == I2C_DONE; }
+};
+
+class I2cQueue
+{
+  public:
+    I2cQueue();
+    /* start the bus task; it should outrank the tasks that submit to it */
+    bool begin(BaseType_t core, UBaseType_t priority, uint32_t stackBytes = 3072u);
+    /* false if the queue is full or the transfer is still in flight */
+    bool submit(I2cTransfer *xfer);
+    /* block the calling task until xfer is done, false on timeout */
+    bool wait(I2cTransfer *xfer, uint32_t timeoutMs);
+    /* submit and wait, for code that has nothing to overlap */
+    bool transfer(I2cTransfer *xfer, uint32_t timeoutMs);
+    uint32_t completed(void) const { return _completed; }
+    uint32_t failed(void) const { return _failed; }
+    uint32_t rejected(void) const { return _rejected; }
+    uint32_t busUs(void) const { return _busUs; }
+  private:
+    QueueHandle_t _queue;
+    TaskHandle_t _task;
+    volatile uint32_t _completed;
+    volatile uint32_t _failed;
+    volatile uint32_t _rejected;
+    volatile uint32_t _busUs;
+    static void taskEntry(void *arg);
+    void run(void);
+    I2cStatus execute(I2cTransfer *xfer);
+};
+
+#endif
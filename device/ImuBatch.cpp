@@ -0,0 +1,140 @@
+#include "ImuBatch.h"
+#include "TelemetryCodec.h"
+#include <string.h>
+
+/* raw word index of each batched axis: accel x y z, (temp skipped), gyro x y z */
+static const uint8_t IMU_BATCH_WORD[IMU_BATCH_AXES] = {0u, 1u, 2u, 4u, 5u, 6u};
+
+/**
+ *
+ */
+ImuBatchEncoder::ImuBatchEncoder(uint8_t periodMs)
+{
+  _periodMs = periodMs;
+  _accelFsr = 0u;
+  _gyroFsr  = 0u;
+  _sequence = 0u;
+  _count    = 0u;
+  _len      = 0u;
+  _t0       = 0u;
+  _lastTime = 0u;
+  memset(_prev, 0, sizeof(_prev));
+}
+
+/**
+ *
+ */
+void ImuBatchEncoder::setScale(uint8_t accelFsr, uint8_t gyroFsr)
+{
+  _accelFsr = accelFsr;
+  _gyroFsr  = gyroFsr;
+}
+
+/**
+ *
+ */
+bool ImuBatchEncoder::add(const int16_t raw[MPU6050_SAMPLE_WORDS], uint32_t timeMs, imuBatch_t &out)
+{
+  int16_t axes[IMU_BATCH_AXES];
+  for(uint8_t n = 0u; n < IMU_BATCH_AXES; n++)
+  {
+    axes[n] = raw[IMU_BATCH_WORD[n]];
+  }
+
+  bool closed = false;
+  if(_count > 0u)
+  {
+    /* a missed sample would break the even spacing, start over; 1.5 periods allows for tick jitter */
+    bool gap  = (timeMs - _lastTime) > ((uint32_t)_periodMs * 3u) / 2u;
+    bool full = (_len + IMU_BATCH_MAX_DELTA + 2u) > IMU_BATCH_BYTES;
+    if(gap || full)
+    {
+      close(out);
+      closed = true;
+    }
+  }
+  if(_count == 0u)
+  {
+    open(axes, timeMs);
+    return closed;
+  }
+
+  for(uint8_t n = 0u; n < IMU_BATCH_AXES; n++)
+  {
+    int32_t delta = (int32_t)axes[n] - (int32_t)_prev[n];
+    uint32_t zz = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+    while(zz >= 0x80u)
+    {
+      _buf[_len++] = (uint8_t)(zz | 0x80u);
+      zz >>= 7;
+    }
+    _buf[_len++] = (uint8_t)zz;
+    _prev[n] = axes[n];
+  }
+  _count++;
+  _lastTime = timeMs;
+  return closed;
+}
+
+/**
+ *
+ */
+bool ImuBatchEncoder::flush(imuBatch_t &out)
+{
+  if(_count == 0u)
+  {
+    return false;
+  }
+  close(out);
+  return true;
+}
+
+/**
+ *
+ */
+void ImuBatchEncoder::open(const int16_t axes[IMU_BATCH_AXES], uint32_t timeMs)
+{
+  _t0 = timeMs;
+  _lastTime = timeMs;
+  _count = 1u;
+  _len = IMU_BATCH_HEADER;
+  for(uint8_t n = 0u; n < IMU_BATCH_AXES; n++)
+  {
+    _buf[_len++] = (uint8_t)axes[n];
+    _buf[_len++] = (uint8_t)((uint16_t)axes[n] >> 8);
+    _prev[n] = axes[n];
+  }
+}
+
+/**
+ *   @brief fill in the header now that the count is known, append the CRC
+ */
+void ImuBatchEncoder::close(imuBatch_t &out)
+{
+  uint16_t seq = _sequence++;
+  _buf[0]  = 'M';
+  _buf[1]  = 'B';
+  _buf[2]  = IMU_BATCH_VERSION;
+  _buf[3]  = IMU_BATCH_TYPE;
+  _buf[4]  = (uint8_t)seq;
+  _buf[5]  = (uint8_t)(seq >> 8);
+  _buf[6]  = (uint8_t)_t0;
+  _buf[7]  = (uint8_t)(_t0 >> 8);
+  _buf[8]  = (uint8_t)(_t0 >> 16);
+  _buf[9]  = (uint8_t)(_t0 >> 24);
+  _buf[10] = _periodMs;
+  _buf[11] = _accelFsr;
+  _buf[12] = _gyroFsr;
+  _buf[13] = (uint8_t)_count;
+  _buf[14] = (uint8_t)(_count >> 8);
+
+  uint16_t crc = telemetryCrc16(_buf, _len);
+  memcpy(out.data, _buf, _len);
+  out.data[_len]      = (uint8_t)crc;
+  out.data[_len + 1u] = (uint8_t)(crc >> 8);
+  out.len      = _len + 2u;
+  out.count    = _count;
+  out.sequence = seq;
+  out.closedAt = _lastTime;
+  _count = 0u;
+}
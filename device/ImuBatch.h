@@ -0,0 +1,85 @@
+/*
+  Batched, delta-encoded full-rate IMU telemetry.
+
+  The sensing task feeds every raw MPU6050 sample (accel and gyro counts)
+  into an ImuBatchEncoder. The first sample of a batch is stored as is;
+  each later one as the per-axis difference to its predecessor, zig-zag
+  mapped and written as a base-128 varint, so a resting board costs about
+  one byte per axis. A batch is closed when the next sample might not fit
+  in one MQTT message, or when a sample is missing, so every batch is an
+  evenly spaced run starting at t0.
+
+  Batch layout (version 1, little endian):
+
+    0   'M' 'B'           magic
+    2   u8   version       IMU_BATCH_VERSION
+    3   u8   type          IMU_BATCH_TYPE
+    4   u16  sequence      +1 per batch, a gap means batches were lost
+    6   u32  t0            ms since boot of the first sample
+   10   u8   period        ms between samples
+   11   u8   accel fsr     ACCEL_CONFIG.AFS_SEL, +-2g << fsr
+   12   u8   gyro fsr      GYRO_CONFIG.FS_SEL, +-250 deg/s << fsr
+   13   u16  count         samples in the batch
+   15   i16  ax ay az gx gy gz  first sample, raw counts
+   27   varint zig-zag deltas, 6 per following sample
+    n   u16  CRC-16/CCITT-FALSE over every byte before it
+*/
+
+#ifndef __IMUBATCH_H__
+#define __IMUBATCH_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <AccelAndGyro.h>
+
+#define IMU_BATCH_VERSION     1u
+#define IMU_BATCH_TYPE        2u
+#define IMU_BATCH_BYTES       448u    /* frame size; sets the RAM of each queued batch, device.ino asserts it fits the MQTT buffer */
+#define IMU_BATCH_AXES        6u
+#define IMU_BATCH_HEADER      15u
+#define IMU_BATCH_MAX_DELTA   (IMU_BATCH_AXES * 3u)   /* a 16 bit zig-zag delta is at most 3 varint bytes */
+
+/*!
+ * A closed batch, ready to publish
+ */
+typedef struct
+{
+  uint16_t len;
+  uint16_t count;
+  uint16_t sequence;
+  uint32_t closedAt;              /**< ms, for deciding when to send */
+  uint8_t data[IMU_BATCH_BYTES];
+}imuBatch_t;
+
+class ImuBatchEncoder
+{
+  public:
+    ImuBatchEncoder(uint8_t periodMs);
+    void setScale(uint8_t accelFsr, uint8_t gyroFsr);
+    /* takes effect with the next batch, flush() first when changing it mid-stream */
+    void setPeriod(uint8_t periodMs) { _periodMs = periodMs; }
+    /* add one sample; true when a batch was closed into out (the sample then opens the next one) */
+    bool add(const int16_t raw[MPU6050_SAMPLE_WORDS], uint32_t timeMs, imuBatch_t &out);
+    /* close a partly filled batch into out, false if empty */
+    bool flush(imuBatch_t &out);
+    /* drop the open batch, e.g. when batching is switched off */
+    void reset(void) { _count = 0u; }
+    uint16_t sequence(void) const { return _sequence; }
+    uint16_t count(void) const { return _count; }
+    uint32_t startedAt(void) const { return _t0; }
+  private:
+    uint8_t _periodMs;
+    uint8_t _accelFsr;
+    uint8_t _gyroFsr;
+    uint16_t _sequence;
+    uint16_t _count;
+    uint16_t _len;
+    uint32_t _t0;
+    uint32_t _lastTime;
+    int16_t _prev[IMU_BATCH_AXES];
+    uint8_t _buf[IMU_BATCH_BYTES];
+    void open(const int16_t axes[IMU_BATCH_AXES], uint32_t timeMs);
+    void close(imuBatch_t &out);
+};
+
+#endif
@@ -0,0 +1,115 @@
+#include "LoopTiming.h"
+#include <string.h>
+
+/**
+ *
+ */
+LoopTiming::LoopTiming(uint32_t periodUs)
+  : _requested(false), _ready(false)
+{
+  _periodUs = periodUs;
+  _tickStartUs = 0u;
+  _first = true;
+  reset(0u);
+  memset(&_report, 0, sizeof(_report));
+}
+
+/**
+ *
+ */
+void LoopTiming::reset(uint32_t nowUs)
+{
+  memset(&_acc, 0, sizeof(_acc));
+  _acc.intervalMinUs = UINT32_MAX;
+  _acc.busyMinUs = UINT32_MAX;
+  _windowStartUs = nowUs;
+}
+
+/**
+ *
+ */
+uint8_t LoopTiming::bucket(const uint32_t *edges, uint32_t value)
+{
+  uint8_t n = 0u;
+  while((n < (TIMING_BUCKETS - 1u)) && (value >= edges[n]))
+  {
+    n++;
+  }
+  return n;
+}
+
+/**
+ *
+ */
+void LoopTiming::begin(uint32_t nowUs)
+{
+  /* hand over the finished window before this tick is counted */
+  if(_requested.load(std::memory_order_acquire) && !_ready.load(std::memory_order_acquire))
+  {
+    _acc.windowUs = nowUs - _windowStartUs;
+    _report = _acc;
+    _requested.store(false, std::memory_order_relaxed);
+    _ready.store(true, std::memory_order_release);
+    reset(nowUs);
+  }
+
+  if(_first)
+  {
+    _first = false;
+    _windowStartUs = nowUs;
+  }
+  else
+  {
+    uint32_t interval = nowUs - _tickStartUs;
+    uint32_t jitter = (interval > _periodUs) ? (interval - _periodUs) : (_periodUs - interval);
+    if(interval < _acc.intervalMinUs) _acc.intervalMinUs = interval;
+    if(interval > _acc.intervalMaxUs) _acc.intervalMaxUs = interval;
+    _acc.intervalSumUs += interval;
+    _acc.intervals++;
+    _acc.jitterHist[bucket(TIMING_JITTER_EDGES_US, jitter)]++;
+    if(interval > _periodUs + _periodUs / 2u)
+    {
+      _acc.late++;
+    }
+  }
+  _tickStartUs = nowUs;
+}
+
+/**
+ *
+ */
+void LoopTiming::end(uint32_t nowUs)
+{
+  uint32_t busy = nowUs - _tickStartUs;
+  _acc.ticks++;
+  if(busy < _acc.busyMinUs) _acc.busyMinUs = busy;
+  if(busy > _acc.busyMaxUs) _acc.busyMaxUs = busy;
+  _acc.busySumUs += busy;
+  _acc.busyHist[bucket(TIMING_BUSY_EDGES_US, busy)]++;
+  if(busy > _periodUs)
+  {
+    _acc.overrun++;
+  }
+}
+
+/**
+ *
+ */
+void LoopTiming::requestReport(void)
+{
+  _requested.store(true, std::memory_order_release);
+}
+
+/**
+ *
+ */
+bool LoopTiming::takeReport(timingReport_t *out)
+{
+  if(!_ready.load(std::memory_order_acquire))
+  {
+    return false;
+  }
+  *out = _report;
+  _ready.store(false, std::memory_order_release);
+  return true;
+}
@@ -0,0 +1,69 @@
+/*
+  Deadline accounting for the periodic sensing loop.
+
+  The sensing task calls begin()/end() around every tick; counters and two
+  fixed-bucket histograms (start jitter and processing time, both in us)
+  accumulate in place. Any task may ask for a report; the sensing task
+  hands over a consistent copy at its next tick and starts a new window,
+  so no lock is ever taken on the sampling path.
+*/
+
+#ifndef __LOOPTIMING_H__
+#define __LOOPTIMING_H__
+
+#include <stdint.h>
+#include <atomic>
+
+#define TIMING_BUCKETS  8u
+
+/* upper bucket edges in us, the last bucket is open ended */
+const uint32_t TIMING_JITTER_EDGES_US[TIMING_BUCKETS - 1u] = {50u, 100u, 250u, 500u, 1000u, 2500u, 5000u};
+const uint32_t TIMING_BUSY_EDGES_US[TIMING_BUCKETS - 1u]   = {250u, 500u, 1000u, 2000u, 4000u, 6000u, 8000u};
+
+/*!
+ * One reporting window of loop timing
+ */
+typedef struct
+{
+  uint32_t windowUs;
+  uint32_t ticks;
+  uint32_t intervals;         /**< tick starts measured against the one before; the first tick of a boot has none */
+  uint32_t late;              /**< ticks that started more than half a period late */
+  uint32_t overrun;           /**< ticks whose processing took longer than the period */
+  uint32_t intervalMinUs;
+  uint32_t intervalMaxUs;
+  uint32_t intervalSumUs;
+  uint32_t busyMinUs;
+  uint32_t busyMaxUs;
+  uint32_t busySumUs;
+  uint32_t jitterHist[TIMING_BUCKETS];  /**< |actual interval - period| */
+  uint32_t busyHist[TIMING_BUCKETS];    /**< processing time per tick */
+}timingReport_t;
+
+class LoopTiming
+{
+  public:
+    LoopTiming(uint32_t periodUs);
+    void setPeriod(uint32_t periodUs) { _periodUs = periodUs; }
+    /* sensing task, start of a tick */
+    void begin(uint32_t nowUs);
+    /* sensing task, end of a tick */
+    void end(uint32_t nowUs);
+    /* any task: ask for the current window at the next tick */
+    void requestReport(void);
+    /* reporting task: true once a requested window has been handed over */
+    bool takeReport(timingReport_t *out);
+  private:
+    uint32_t _periodUs;
+    uint32_t _tickStartUs;
+    uint32_t _windowStartUs;
+    bool _first;
+    timingReport_t _acc;
+    timingReport_t _report;
+    std::atomic<bool> _requested;
+    std::atomic<bool> _ready;
+    void reset(uint32_t nowUs);
+    static uint8_t bucket(const uint32_t *edges, uint32_t value);
+};
+
+#endif
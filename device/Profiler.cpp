@@ -0,0 +1,140 @@
+#include "Profiler.h"
+
+static const char *const PROFILE_STAGE_NAMES[PROF_STAGES] =
+{
+  "i2c_read", "convert", "filter", "detect", "slow_sensors", "json_encode", "publish"
+};
+
+/**
+ *
+ */
+const char *profileStageName(uint8_t stage)
+{
+  return (stage < PROF_STAGES) ? PROFILE_STAGE_NAMES[stage] : "?";
+}
+
+#if MYOSA_PROFILE
+
+#include <atomic>
+#include <string.h>
+
+typedef struct
+{
+  uint32_t count;
+  uint32_t minCycles;
+  uint32_t maxCycles;
+  uint64_t sumCycles;
+  uint32_t hist[PROF_HIST_BUCKETS];
+}profileSlot_t;
+
+static profileSlot_t profileTable[PROF_STAGES];
+static std::atomic<uint32_t> profileResetMask(0u);
+
+/**
+ *   @brief log-scale bucket: octave of the top bit, then the next two bits
+ */
+static uint16_t profileBucket(uint32_t cycles)
+{
+  if(cycles < (1u << PROF_HIST_MIN_BIT))
+  {
+    return 0u;
+  }
+  uint32_t msb = 31u - (uint32_t)__builtin_clz(cycles);
+  uint32_t octave = msb - PROF_HIST_MIN_BIT;
+  if(octave >= PROF_HIST_OCTAVES)
+  {
+    return PROF_HIST_BUCKETS - 1u;
+  }
+  uint32_t sub = (cycles >> (msb - 2u)) & (PROF_HIST_SUB - 1u);
+  return (uint16_t)(1u + octave * PROF_HIST_SUB + sub);
+}
+
+/**
+ *   @brief largest cycle count that still falls into the bucket
+ */
+static uint32_t profileBucketTop(uint16_t bucket)
+{
+  if(bucket == 0u)
+  {
+    return (1u << PROF_HIST_MIN_BIT) - 1u;
+  }
+  uint32_t octave = (bucket - 1u) / PROF_HIST_SUB;
+  uint32_t sub    = (bucket - 1u) % PROF_HIST_SUB;
+  uint32_t msb    = octave + PROF_HIST_MIN_BIT;
+  return ((PROF_HIST_SUB + sub + 1u) << (msb - 2u)) - 1u;
+}
+
+/**
+ *
+ */
+void profileRecord(uint8_t stage, uint32_t cycles)
+{
+  if(stage >= PROF_STAGES)
+  {
+    return;
+  }
+  profileSlot_t &slot = profileTable[stage];
+  uint32_t bit = 1u << stage;
+  if(profileResetMask.load(std::memory_order_acquire) & bit)
+  {
+    memset(&slot, 0, sizeof(slot));
+    profileResetMask.fetch_and(~bit, std::memory_order_release);
+  }
+  if((slot.count == 0u) || (cycles < slot.minCycles))
+  {
+    slot.minCycles = cycles;
+  }
+  if(cycles > slot.maxCycles)
+  {
+    slot.maxCycles = cycles;
+  }
+  slot.sumCycles += cycles;
+  slot.hist[profileBucket(cycles)]++;
+  slot.count++;
+}
+
+/**
+ *
+ */
+bool profileSummary(uint8_t stage, profileSummary_t *out)
+{
+  if(stage >= PROF_STAGES)
+  {
+    return false;
+  }
+  const profileSlot_t &slot = profileTable[stage];
+  uint32_t count = slot.count;
+  if((count == 0u) || (profileResetMask.load(std::memory_order_acquire) & (1u << stage)))
+  {
+    return false;
+  }
+  out->count      = count;
+  out->minCycles  = slot.minCycles;
+  out->maxCycles  = slot.maxCycles;
+  out->meanCycles = (uint32_t)(slot.sumCycles / count);
+
+  uint32_t target = count - count / 100u;
+  uint32_t seen = 0u;
+  out->p99Cycles = slot.maxCycles;
+  for(uint16_t b = 0u; b < PROF_HIST_BUCKETS; b++)
+  {
+    seen += slot.hist[b];
+    if(seen >= target)
+    {
+      uint32_t top = profileBucketTop(b);
+      out->p99Cycles = (top < slot.maxCycles) ? top : slot.maxCycles;
+      break;
+    }
+  }
+  return true;
+}
+
+/**
+ *
+ */
+void profileReset(void)
+{
+  profileResetMask.store((1u << PROF_STAGES) - 1u, std::memory_order_release);
+}
+
+#endif
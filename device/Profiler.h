@@ -0,0 +1,86 @@
+/*
+  Per-stage cycle-count profiler for the firmware hot path.
+
+  PROFILE_SCOPE(stage) reads the CPU cycle counter on entry and exit of the
+  enclosing block and folds the difference into that stage's slot of a
+  fixed table: count, min, max, sum and a log-scale histogram (4 buckets
+  per octave) from which p99 is estimated without storing samples. Each
+  stage is only ever recorded from one task, and both tasks are pinned, so
+  the per-core counters are consistent and no lock is needed. A dump taken
+  while the other core records may be off by the sample in flight.
+
+  Build with MYOSA_PROFILE=1 to enable; otherwise the macros expand to
+  nothing and the table is not linked in.
+*/
+
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+#include <stdint.h>
+
+#ifndef MYOSA_PROFILE
+#define MYOSA_PROFILE   0
+#endif
+
+enum ProfileStage : uint8_t
+{
+  PROF_I2C_READ,      /**< MPU6050 14 byte burst */
+  PROF_CONVERT,       /**< raw counts to units and tilt */
+  PROF_FILTER,        /**< gravity / EMA filters, magnitudes, motion energy */
+  PROF_DETECT,        /**< fall, post-fall and temperature checks */
+  PROF_SLOW_SENSORS,  /**< one scheduler pass over the slow boards */
+  PROF_JSON_ENCODE,   /**< building and serialising a payload */
+  PROF_PUBLISH,       /**< MQTT publish call */
+  PROF_STAGES
+};
+
+#define PROF_HIST_SUB       4u                  /* buckets per power of two */
+#define PROF_HIST_MIN_BIT   6u                  /* everything below 64 cycles lands in bucket 0 */
+#define PROF_HIST_OCTAVES   22u                 /* up to 2^28 cycles, >1 s at 240 MHz */
+#define PROF_HIST_BUCKETS   (1u + PROF_HIST_OCTAVES * PROF_HIST_SUB)
+
+/*!
+ * Summary of one stage, all times in CPU cycles
+ */
+typedef struct
+{
+  uint32_t count;
+  uint32_t minCycles;
+  uint32_t meanCycles;
+  uint32_t maxCycles;
+  uint32_t p99Cycles;         /**< upper edge of the bucket holding the 99th percentile */
+}profileSummary_t;
+
+const char *profileStageName(uint8_t stage);
+
+#if MYOSA_PROFILE
+
+#include <Arduino.h>
+
+void profileRecord(uint8_t stage, uint32_t cycles);
+/* false when the stage has not been hit since the last reset */
+bool profileSummary(uint8_t stage, profileSummary_t *out);
+/* clear every stage; each stage is cleared by its own task on its next record */
+void profileReset(void);
+
+class ProfileScope
+{
+  public:
+    ProfileScope(uint8_t stage) : _stage(stage), _start(ESP.getCycleCount()) {}
+    ~ProfileScope() { profileRecord(_stage, ESP.getCycleCount() - _start); }
+  private:
+    uint8_t _stage;
+    uint32_t _start;
+};
+
+#define PROFILE_CONCAT_(a, b)   a##b
+#define PROFILE_CONCAT(a, b)    PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(stage)    ProfileScope PROFILE_CONCAT(_profileScope, __LINE__)(stage)
+
+#else
+
+#define PROFILE_SCOPE(stage)    do { } while(0)
+
+#endif
+
+#endif
@@ -0,0 +1,90 @@
+#include "PublishPolicy.h"
+#include <math.h>
+
+/* deadband used by each compared value */
+static const uint8_t PUBLISH_VALUE_DEADBAND[PV_COUNT] =
+{
+  DB_TEMP, DB_TILT, DB_TILT, DB_TILT, DB_MOTION, DB_PRESSURE, DB_HUMIDITY, DB_CO2, DB_LIGHT
+};
+
+/**
+ *
+ */
+PublishPolicy::PublishPolicy()
+{
+  cfg.minMs       = 2000u;
+  cfg.activeMs    = 2000u;
+  cfg.heartbeatMs = 60000u;
+  cfg.deadband[DB_TEMP]     = 0.2f;
+  cfg.deadband[DB_TILT]     = 10.f;
+  cfg.deadband[DB_MOTION]   = 20.f;
+  cfg.deadband[DB_PRESSURE] = 1.f;
+  cfg.deadband[DB_HUMIDITY] = 2.f;
+  cfg.deadband[DB_CO2]      = 100.f;
+  cfg.deadband[DB_LIGHT]    = 50.f;
+  _last  = 0u;
+  _first = true;
+  for(uint8_t n = 0u; n < PV_COUNT; n++)
+  {
+    _lastValues[n] = 0.f;
+  }
+}
+
+/**
+ *
+ */
+PublishReason PublishPolicy::check(unsigned long now, const float values[PV_COUNT], bool elevated) const
+{
+  if(_first)
+  {
+    return PUBLISH_HEARTBEAT;
+  }
+  unsigned long elapsed = now - _last;
+  if(elapsed >= cfg.heartbeatMs)
+  {
+    return PUBLISH_HEARTBEAT;
+  }
+  if(elevated && (elapsed >= cfg.activeMs))
+  {
+    return PUBLISH_ACTIVE;
+  }
+  if(elapsed < cfg.minMs)
+  {
+    return PUBLISH_NONE;
+  }
+  for(uint8_t n = 0u; n < PV_COUNT; n++)
+  {
+    if(fabsf(values[n] - _lastValues[n]) > cfg.deadband[PUBLISH_VALUE_DEADBAND[n]])
+    {
+      return PUBLISH_CHANGE;
+    }
+  }
+  return PUBLISH_NONE;
+}
+
+/**
+ *
+ */
+void PublishPolicy::published(unsigned long now, const float values[PV_COUNT])
+{
+  _last  = now;
+  _first = false;
+  for(uint8_t n = 0u; n < PV_COUNT; n++)
+  {
+    _lastValues[n] = values[n];
+  }
+}
+
+/**
+ *
+ */
+const char *PublishPolicy::reasonName(PublishReason reason)
+{
+  switch(reason)
+  {
+    case PUBLISH_HEARTBEAT: return "heartbeat";
+    case PUBLISH_CHANGE:    return "change";
+    case PUBLISH_ACTIVE:    return "active";
+    default:                return "none";
+  }
+}
@@ -0,0 +1,88 @@
+/*
+  Change-driven telemetry rate.
+
+  Instead of a fixed interval the sensing task asks the policy on every
+  sample whether a telemetry publish is due:
+
+    - elevated state (movement, post-fall watch, open alert): every activeMs
+    - a channel moved past its deadband since the last publish: at most every minMs
+    - otherwise a heartbeat every heartbeatMs
+
+  Intervals and deadbands are part of the runtime parameter set
+  (DetectionConfig) and are copied into cfg by the sensing task itself when
+  it switches sets, so check() never sees half an update.
+*/
+
+#ifndef __PUBLISHPOLICY_H__
+#define __PUBLISHPOLICY_H__
+
+#include <stdint.h>
+
+#define PUBLISH_MIN_FLOOR_MS    500u      /* configured intervals below this are rejected */
+
+/* channels compared against a deadband, in PublishPolicy::check() order */
+enum PublishValue : uint8_t
+{
+  PV_TEMP,
+  PV_TILT_X,
+  PV_TILT_Y,
+  PV_TILT_Z,
+  PV_MOTION,
+  PV_PRESSURE,
+  PV_HUMIDITY,
+  PV_CO2,
+  PV_LIGHT,
+  PV_COUNT
+};
+
+/* configurable deadbands; the three tilt axes share one */
+enum PublishDeadband : uint8_t
+{
+  DB_TEMP,          /* degC */
+  DB_TILT,          /* deg, any axis */
+  DB_MOTION,        /* motion energy */
+  DB_PRESSURE,      /* hPa */
+  DB_HUMIDITY,      /* %RH */
+  DB_CO2,           /* ppm */
+  DB_LIGHT,         /* ambient light counts */
+  DB_COUNT
+};
+
+static const char *const PUBLISH_DEADBAND_NAMES[DB_COUNT] =
+{
+  "temp", "tilt", "motion", "pressure", "humidity", "co2", "light"
+};
+
+enum PublishReason : uint8_t
+{
+  PUBLISH_NONE,
+  PUBLISH_HEARTBEAT,
+  PUBLISH_CHANGE,
+  PUBLISH_ACTIVE
+};
+
+struct PublishPolicyConfig
+{
+  volatile uint32_t minMs;
+  volatile uint32_t activeMs;
+  volatile uint32_t heartbeatMs;
+  volatile float deadband[DB_COUNT];
+};
+
+class PublishPolicy
+{
+  public:
+    PublishPolicy();
+    /* sensing task, every sample */
+    PublishReason check(unsigned long now, const float values[PV_COUNT], bool elevated) const;
+    /* sensing task, after the sample was queued */
+    void published(unsigned long now, const float values[PV_COUNT]);
+    static const char *reasonName(PublishReason reason);
+    PublishPolicyConfig cfg;
+  private:
+    unsigned long _last;
+    bool _first;
+    float _lastValues[PV_COUNT];
+};
+
+#endif
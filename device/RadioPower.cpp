@@ -0,0 +1,151 @@
+#include "RadioPower.h"
+#include <string.h>
+
+/**
+ *
+ */
+RadioPower::RadioPower(uint8_t listenDtims, uint8_t apDtim, uint32_t burstMs, uint32_t pollMs)
+{
+  _listenInterval = (uint16_t)listenDtims * apDtim;
+  if(_listenInterval == 0u)
+  {
+    _listenInterval = 1u;
+  }
+  _burstMs = burstMs;
+  _pollMs = pollMs;
+  _state = RADIO_OFF;
+  _since = 0u;
+  _lastBurst = 0u;
+  _lastPoll = 0u;
+  _hourStart = 0u;
+  memset(&_hour, 0, sizeof(_hour));
+  memset(&_lastHour, 0, sizeof(_lastHour));
+}
+
+/**
+ *   @brief WiFi.begin(ssid, pass) would build a station config without the listen interval
+ */
+void RadioPower::connect(const char *ssid, const char *pass, unsigned long now)
+{
+  wifi_config_t conf;
+  memset(&conf, 0, sizeof(conf));
+  strncpy((char *)conf.sta.ssid, ssid, sizeof(conf.sta.ssid));
+  strncpy((char *)conf.sta.password, pass, sizeof(conf.sta.password));
+  conf.sta.listen_interval = _listenInterval;
+  WiFi.mode(WIFI_STA);   /* idle() may have switched the radio off */
+  esp_wifi_set_config(WIFI_IF_STA, &conf);
+  enter(RADIO_CONNECTING, now);
+  WiFi.begin();     /* associates with the config just set */
+}
+
+/**
+ *
+ */
+void RadioPower::idle(unsigned long now)
+{
+  enter(RADIO_OFF, now);
+}
+
+/**
+ *
+ */
+void RadioPower::wake(unsigned long now, bool burst)
+{
+  /* any wake sends everything deferred, so it also counts as this slot's burst */
+  _lastBurst = now;
+  if(_state == RADIO_AWAKE)
+  {
+    return;
+  }
+  if(_state == RADIO_DOZE)
+  {
+    _hour.wakes++;
+    if(burst)
+    {
+      _hour.bursts++;
+    }
+  }
+  enter(RADIO_AWAKE, now);
+}
+
+/**
+ *
+ */
+void RadioPower::doze(unsigned long now)
+{
+  if(_state == RADIO_AWAKE)
+  {
+    enter(RADIO_DOZE, now);
+  }
+}
+
+/**
+ *
+ */
+bool RadioPower::burstDue(unsigned long now) const
+{
+  return (now / _burstMs) != (_lastBurst / _burstMs);
+}
+
+/**
+ *
+ */
+bool RadioPower::pollDue(unsigned long now)
+{
+  if((now - _lastPoll) < _pollMs)
+  {
+    return false;
+  }
+  _lastPoll = now;
+  return true;
+}
+
+/**
+ *
+ */
+void RadioPower::update(unsigned long now)
+{
+  _hour.ms[_state] += now - _since;
+  _since = now;
+  if((now - _hourStart) >= RADIO_HOUR_MS)
+  {
+    _lastHour = _hour;
+    memset(&_hour, 0, sizeof(_hour));
+    _hourStart = now;
+  }
+}
+
+/**
+ *   @brief connecting and awake count in full, modem sleep by its listen duty cycle
+ */
+uint32_t RadioPower::onMs(const radioHour_t &h) const
+{
+  uint64_t doze = (uint64_t)h.ms[RADIO_DOZE] * RADIO_BEACON_RX_US / ((uint64_t)_listenInterval * RADIO_BEACON_US);
+  return h.ms[RADIO_CONNECTING] + h.ms[RADIO_AWAKE] + (uint32_t)doze;
+}
+
+/**
+ *
+ */
+void RadioPower::enter(RadioState next, unsigned long now)
+{
+  if(next == _state)
+  {
+    return;
+  }
+  update(now);
+  _state = next;
+  if(next == RADIO_DOZE)
+  {
+    WiFi.setSleep(WIFI_PS_MAX_MODEM);
+  }
+  else if(next == RADIO_OFF)
+  {
+    /* counted as off, so it has to be off: no association kept up meanwhile */
+    WiFi.mode(WIFI_OFF);
+  }
+  else
+  {
+    WiFi.setSleep(WIFI_PS_NONE);
+  }
+}
@@ -0,0 +1,95 @@
+/*
+  Radio duty cycle for the Wi-Fi link.
+
+  Between uploads the station sits in modem sleep (WIFI_PS_MAX_MODEM) and
+  only wakes for every listenInterval-th beacon. The interval is given in
+  DTIM periods of the access point, so the wake-ups land on the beacons
+  that also release buffered broadcast traffic instead of adding their own.
+  Frames for the station wait at the AP until then.
+
+  Outbound traffic is grouped: deferred messages collect in their queues
+  and go out in one burst per burst period, the periods aligned to
+  multiples of burstMs. For a burst, or for anything that cannot wait
+  (alerts, command answers), the caller wakes the radio fully
+  (WIFI_PS_NONE). It then sends, and lets it doze again once the queues
+  are empty.
+
+  Time is accounted per state and reported for the current and the last
+  full hour. In modem sleep the receiver is only on around each listened
+  beacon; that share is estimated from the listen interval.
+*/
+
+#ifndef __RADIOPOWER_H__
+#define __RADIOPOWER_H__
+
+#include <stdint.h>
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_wifi.h>
+
+#define RADIO_BEACON_US       102400u   /* 100 TU, the usual beacon interval */
+#define RADIO_BEACON_RX_US    3000u     /* receiver on per listened beacon, wake-up included */
+#define RADIO_HOUR_MS         3600000u
+
+enum RadioState : uint8_t
+{
+  RADIO_OFF,          /* not associated, not trying */
+  RADIO_CONNECTING,   /* scan, association, DHCP */
+  RADIO_AWAKE,        /* associated, power save off */
+  RADIO_DOZE,         /* associated, modem sleep */
+  RADIO_STATES
+};
+
+/*!
+ * Time per radio state over one hour
+ */
+typedef struct
+{
+  uint32_t ms[RADIO_STATES];
+  uint32_t wakes;             /**< doze -> awake transitions */
+  uint32_t bursts;            /**< of them, scheduled bursts */
+}radioHour_t;
+
+class RadioPower
+{
+  public:
+    /* listenDtims: DTIM periods per wake in modem sleep; apDtim: DTIM period of the AP in beacons */
+    RadioPower(uint8_t listenDtims, uint8_t apDtim, uint32_t burstMs, uint32_t pollMs);
+    /* station config with the listen interval, then associate; replaces WiFi.begin(ssid, pass) */
+    void connect(const char *ssid, const char *pass, unsigned long now);
+    /* link down, given up for now (backoff): radio off until connect() */
+    void idle(unsigned long now);
+    /* power save off until doze(); burst marks a scheduled burst */
+    void wake(unsigned long now, bool burst = false);
+    /* back to modem sleep, only while associated */
+    void doze(unsigned long now);
+    bool awake(void) const { return _state == RADIO_AWAKE; }
+    /* an aligned burst slot has started since the last burst */
+    bool burstDue(unsigned long now) const;
+    /* time for client.loop() while dozing: incoming commands, keepalive */
+    bool pollDue(unsigned long now);
+    /* account elapsed time, roll the hour; every network pass */
+    void update(unsigned long now);
+    RadioState state(void) const { return _state; }
+    uint16_t listenInterval(void) const { return _listenInterval; }
+    const radioHour_t &thisHour(void) const { return _hour; }
+    const radioHour_t &lastHour(void) const { return _lastHour; }
+    uint32_t hourElapsedMs(unsigned long now) const { return now - _hourStart; }
+    /* estimated receiver/transmitter on time of one hour record */
+    uint32_t onMs(const radioHour_t &h) const;
+  private:
+    uint16_t _listenInterval;   /* beacons */
+    uint32_t _burstMs;
+    uint32_t _pollMs;
+    RadioState _state;
+    unsigned long _since;
+    unsigned long _lastBurst;
+    unsigned long _lastPoll;
+    unsigned long _hourStart;
+    radioHour_t _hour;
+    radioHour_t _lastHour;
+
+    void enter(RadioState next, unsigned long now);
+};
+
+#endif
@@ -0,0 +1,383 @@
+#include "SensorScheduler.h"
+
+/* state shared by every sensor: nothing running, waiting for the next period */
+#define STATE_IDLE      0u
+
+/**
+ *
+ */
+PolledSensor::PolledSensor(const char *name, uint32_t periodMs)
+{
+  _name       = name;
+  _periodMs   = periodMs;
+  _state      = STATE_IDLE;
+  _wakeAt     = 0u;
+  _startedAt  = 0u;
+  _cycleStart = 0u;
+  _readings   = 0u;
+  _errors     = 0u;
+}
+
+/**
+ *
+ */
+bool PolledSensor::isDue(unsigned long now) const
+{
+  return (long)(now - _wakeAt) >= 0;
+}
+
+/**
+ *   @brief enter a conversion state and come back after waitMs
+ */
+void PolledSensor::enter(unsigned long now, uint8_t state, uint32_t waitMs)
+{
+  if(_state == STATE_IDLE)
+  {
+    _cycleStart = now;
+  }
+  _state     = state;
+  _startedAt = now;
+  _wakeAt    = now + waitMs;
+}
+
+/**
+ *   @brief close the cycle, next one starts a period after this one started
+ */
+void PolledSensor::finish(unsigned long now, bool ok)
+{
+  if(ok)
+  {
+    _readings++;
+  }
+  else
+  {
+    _errors++;
+  }
+  _state  = STATE_IDLE;
+  _wakeAt = _cycleStart + _periodMs;
+  if((long)(_wakeAt - now) < 0)
+  {
+    _wakeAt = now;
+  }
+}
+
+/**
+ *   @brief keep polling every tick until limitMs has passed since the conversion started
+ */
+bool PolledSensor::timedOut(unsigned long now, uint32_t limitMs)
+{
+  if((now - _startedAt) >= limitMs)
+  {
+    return true;
+  }
+  _wakeAt = now + 1u;
+  return false;
+}
+
+/* ---------------------------------------------------------------- BMP180 */
+#define BARO_TEMP       1u
+#define BARO_START_P    2u
+#define BARO_PRESSURE   3u
+
+/**
+ *
+ */
+BaroSensor::BaroSensor(BarometricPressure &dev, envReadings_t &env, uint32_t periodMs)
+  : PolledSensor("baro", periodMs), _dev(dev), _env(env)
+{
+  _UT = 0;
+}
+
+/**
+ *
+ */
+void BaroSensor::step(unsigned long now)
+{
+  int32_t UP;
+  switch(_state)
+  {
+    case STATE_IDLE:
+      if(_dev.startTemperature() == false)
+      {
+        finish(now, false);
+        return;
+      }
+      enter(now, BARO_TEMP, 5u);
+      break;
+    case BARO_TEMP:
+      if(_dev.isConversionDone() == false)
+      {
+        if(i2cFailed(_dev.busResult()) || timedOut(now, SCHED_CONVERSION_TIMEOUT))
+        {
+          finish(now, false);
+        }
+        return;
+      }
+      if(_dev.readRawTemperatureResult(&_UT) == false)
+      {
+        finish(now, false);
+        return;
+      }
+      enter(now, BARO_START_P, 0u);
+      break;
+    case BARO_START_P:
+      if(_dev.startPressure() == false)
+      {
+        finish(now, false);
+        return;
+      }
+      enter(now, BARO_PRESSURE, 5u);
+      break;
+    case BARO_PRESSURE:
+      if(_dev.isConversionDone() == false)
+      {
+        if(i2cFailed(_dev.busResult()) || timedOut(now, SCHED_CONVERSION_TIMEOUT))
+        {
+          finish(now, false);
+        }
+        return;
+      }
+      if(_dev.readRawPressureResult(&UP) == false)
+      {
+        finish(now, false);
+        return;
+      }
+      _env.baroTempC   = _dev.computeTemperature(_UT);
+      _env.pressureHpa = _dev.computePressure(_UT, UP) / 100.f;
+      _env.baroTime    = now;
+      finish(now, true);
+      break;
+    default:
+      finish(now, false);
+      break;
+  }
+}
+
+/* ---------------------------------------------------------------- Si7021 */
+#define HUM_MEASURING   1u
+#define HUM_TEMP        2u
+
+/**
+ *
+ */
+HumiditySensor::HumiditySensor(TempAndHumidity &dev, envReadings_t &env, uint32_t periodMs)
+  : PolledSensor("humidity", periodMs), _dev(dev), _env(env)
+{
+  _rh = 0.f;
+}
+
+/**
+ *
+ */
+void HumiditySensor::step(unsigned long now)
+{
+  float tempC;
+  switch(_state)
+  {
+    case STATE_IDLE:
+      if(_dev.startHumidity() == false)
+      {
+        finish(now, false);
+        return;
+      }
+      /* 12 bit RH plus the 14 bit temperature it takes along: ~20 ms */
+      enter(now, HUM_MEASURING, 20u);
+      break;
+    case HUM_MEASURING:
+      if(_dev.readHumidityResult(&_rh) == false)
+      {
+        if(i2cFailed(_dev.busResult()) || timedOut(now, SCHED_CONVERSION_TIMEOUT))
+        {
+          finish(now, false);
+        }
+        return;
+      }
+      enter(now, HUM_TEMP, 0u);
+      break;
+    case HUM_TEMP:
+      if(_dev.readTempFromHumidity(&tempC) == false)
+      {
+        finish(now, false);
+        return;
+      }
+      _env.humidity = _rh;
+      _env.humTempC = tempC;
+      _env.humTime  = now;
+      finish(now, true);
+      break;
+    default:
+      finish(now, false);
+      break;
+  }
+}
+
+/* ---------------------------------------------------------------- CCS811 */
+#define AIR_WAIT_DATA   1u
+#define AIR_READ        2u
+#define AIR_COMPENSATE  3u
+
+/**
+ *
+ */
+AirSensor::AirSensor(AirQuality &dev, envReadings_t &env, uint32_t periodMs)
+  : PolledSensor("air", periodMs), _dev(dev), _env(env)
+{
+  _lastCompensation = 0u;
+}
+
+/**
+ *
+ */
+void AirSensor::step(unsigned long now)
+{
+  switch(_state)
+  {
+    case STATE_IDLE:
+      /* the CCS811 free-runs in drive mode 1, nothing to start */
+      enter(now, AIR_WAIT_DATA, 0u);
+      break;
+    case AIR_WAIT_DATA:
+      if(_dev.isDataAvailable() == false)
+      {
+        if(i2cFailed(_dev.busResult()) || timedOut(now, period() + SCHED_CONVERSION_TIMEOUT))
+        {
+          finish(now, false);
+        }
+        else
+        {
+          _wakeAt = now + 50u;
+        }
+        return;
+      }
+      enter(now, AIR_READ, 0u);
+      break;
+    case AIR_READ:
+      if(_dev.readAlgorithmResults() != SENSOR_SUCCESS)
+      {
+        finish(now, false);
+        return;
+      }
+      _env.co2     = _dev.getCO2();
+      _env.tvoc    = _dev.getTVOC();
+      _env.airTime = now;
+      if((_env.humTime != 0u) && (_env.humTime != _lastCompensation))
+      {
+        enter(now, AIR_COMPENSATE, 0u);
+        return;
+      }
+      finish(now, true);
+      break;
+    case AIR_COMPENSATE:
+      _lastCompensation = _env.humTime;
+      finish(now, _dev.setEnvironmentalData(_env.humidity, _env.humTempC) == SENSOR_SUCCESS);
+      break;
+    default:
+      finish(now, false);
+      break;
+  }
+}
+
+/* -------------------------------------------------------------- APDS9960 */
+#define LIGHT_WAIT_ALS  1u
+#define LIGHT_READ_ALS  2u
+#define LIGHT_READ_PRX  3u
+
+/**
+ *
+ */
+LightSensor::LightSensor(LightProximityAndGesture &dev, envReadings_t &env, uint32_t periodMs)
+  : PolledSensor("light", periodMs), _dev(dev), _env(env)
+{
+}
+
+/**
+ *
+ */
+void LightSensor::step(unsigned long now)
+{
+  switch(_state)
+  {
+    case STATE_IDLE:
+      enter(now, LIGHT_WAIT_ALS, 0u);
+      break;
+    case LIGHT_WAIT_ALS:
+      if(_dev.isAmbientLightValid() == false)
+      {
+        /* one ALS integration at the default ATIME is ~103 ms */
+        if(i2cFailed(_dev.busResult()) || timedOut(now, 3u * SCHED_CONVERSION_TIMEOUT))
+        {
+          finish(now, false);
+        }
+        return;
+      }
+      enter(now, LIGHT_READ_ALS, 0u);
+      break;
+    case LIGHT_READ_ALS:
+      if(_dev.readAmbientLight(&_env.ambientLight) == false)
+      {
+        finish(now, false);
+        return;
+      }
+      enter(now, LIGHT_READ_PRX, 0u);
+      break;
+    case LIGHT_READ_PRX:
+      if(_dev.readProximity(&_env.proximity) == false)
+      {
+        finish(now, false);
+        return;
+      }
+      _env.lightTime = now;
+      finish(now, true);
+      break;
+    default:
+      finish(now, false);
+      break;
+  }
+}
+
+/* ------------------------------------------------------------- scheduler */
+/**
+ *
+ */
+SensorScheduler::SensorScheduler()
+{
+  _count = 0u;
+  _next  = 0u;
+}
+
+/**
+ *
+ */
+bool SensorScheduler::add(PolledSensor *sensor)
+{
+  if(_count >= SCHED_MAX_SENSORS)
+  {
+    return false;
+  }
+  _sensors[_count++] = sensor;
+  return true;
+}
+
+/**
+ *
+ */
+uint8_t SensorScheduler::run(unsigned long now, uint32_t budgetUs)
+{
+  uint32_t t0 = micros();
+  uint8_t steps = 0u;
+  for(uint8_t n = 0u; n < _count; n++)
+  {
+    if((uint32_t)(micros() - t0) >= budgetUs)
+    {
+      break;
+    }
+    PolledSensor *sensor = _sensors[_next];
+    _next = (_next + 1u) % _count;
+    if(sensor->isDue(now))
+    {
+      sensor->step(now);
+      steps++;
+    }
+  }
+  return steps;
+}
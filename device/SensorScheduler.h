@@ -0,0 +1,142 @@
+/*
+  Cooperative multi-rate scheduler for the slow MYOSA sensor boards.
+
+  Every board runs as a small start-conversion / poll-ready / collect state
+  machine. A step is one or two short I2C transactions and never waits on
+  the sensor, so the scheduler can be run after each IMU sample with a
+  fixed time budget and the IMU deadline is never pushed back. Conversion
+  time that the original drivers spent in delay_ms() now simply passes
+  between steps.
+
+  A poll that comes back negative because the bus failed, rather than
+  because the conversion is still running, ends the cycle as an error at
+  once instead of waiting out the conversion timeout.
+*/
+
+#ifndef __SENSORSCHEDULER_H__
+#define __SENSORSCHEDULER_H__
+
+#include <stdint.h>
+#include <Arduino.h>
+#include <BarometricPressure.h>
+#include <TempAndHumidity.h>
+#include <AirQuality.h>
+#include <LightProximityAndGesture.h>
+
+#define SCHED_MAX_SENSORS         6u
+#define SCHED_CONVERSION_TIMEOUT  150u    /* ms, a conversion taking longer is counted as an error */
+
+/*!
+ * Latest values collected by the scheduled sensors, 0 time means never read
+ */
+typedef struct
+{
+  float pressureHpa;
+  float baroTempC;
+  unsigned long baroTime;
+  float humidity;
+  float humTempC;
+  unsigned long humTime;
+  uint16_t co2;
+  uint16_t tvoc;
+  unsigned long airTime;
+  uint16_t ambientLight;
+  uint8_t proximity;
+  unsigned long lightTime;
+}envReadings_t;
+
+class PolledSensor
+{
+  public:
+    PolledSensor(const char *name, uint32_t periodMs);
+    virtual ~PolledSensor() {}
+    /* true when the state machine wants a step at this time */
+    bool isDue(unsigned long now) const;
+    /* one bounded, non-blocking step of the state machine */
+    virtual void step(unsigned long now) = 0;
+    const char *name(void) const { return _name; }
+    uint32_t period(void) const { return _periodMs; }
+    void setPeriod(uint32_t periodMs) { _periodMs = periodMs; }
+    uint32_t readings(void) const { return _readings; }
+    uint32_t errors(void) const { return _errors; }
+  protected:
+    uint8_t _state;
+    unsigned long _wakeAt;      /* next time a step is wanted */
+    unsigned long _startedAt;   /* start of the running conversion */
+    /* move to a conversion state and come back after waitMs */
+    void enter(unsigned long now, uint8_t state, uint32_t waitMs);
+    /* back to idle until the next period */
+    void finish(unsigned long now, bool ok);
+    /* keep polling the running conversion, true once limitMs has passed */
+    bool timedOut(unsigned long now, uint32_t limitMs);
+  private:
+    const char *_name;
+    uint32_t _periodMs;
+    unsigned long _cycleStart;
+    uint32_t _readings;
+    uint32_t _errors;
+};
+
+/* BMP180: temperature conversion, then pressure conversion, then compensate */
+class BaroSensor : public PolledSensor
+{
+  public:
+    BaroSensor(BarometricPressure &dev, envReadings_t &env, uint32_t periodMs);
+    void step(unsigned long now);
+  private:
+    BarometricPressure &_dev;
+    envReadings_t &_env;
+    int32_t _UT;
+};
+
+/* Si7021: No Hold Master RH conversion, then the temperature it measured on the way */
+class HumiditySensor : public PolledSensor
+{
+  public:
+    HumiditySensor(TempAndHumidity &dev, envReadings_t &env, uint32_t periodMs);
+    void step(unsigned long now);
+  private:
+    TempAndHumidity &_dev;
+    envReadings_t &_env;
+    float _rh;
+};
+
+/* CCS811: poll DATA_READY, read the algorithm result, feed back RH/T compensation */
+class AirSensor : public PolledSensor
+{
+  public:
+    AirSensor(AirQuality &dev, envReadings_t &env, uint32_t periodMs);
+    void step(unsigned long now);
+  private:
+    AirQuality &_dev;
+    envReadings_t &_env;
+    unsigned long _lastCompensation;
+};
+
+/* APDS9960: ALS and proximity engines free-run, collect once valid */
+class LightSensor : public PolledSensor
+{
+  public:
+    LightSensor(LightProximityAndGesture &dev, envReadings_t &env, uint32_t periodMs);
+    void step(unsigned long now);
+  private:
+    LightProximityAndGesture &_dev;
+    envReadings_t &_env;
+};
+
+class SensorScheduler
+{
+  public:
+    SensorScheduler();
+    bool add(PolledSensor *sensor);
+    /* run due steps round-robin until budgetUs is used up, returns steps taken */
+    uint8_t run(unsigned long now, uint32_t budgetUs);
+    uint8_t count(void) const { return _count; }
+    PolledSensor *get(uint8_t index) const { return _sensors[index]; }
+  private:
+    PolledSensor *_sensors[SCHED_MAX_SENSORS];
+    uint8_t _count;
+    uint8_t _next;
+};
+
+#endif
@@ -0,0 +1,91 @@
+/*
+  Bounded single-producer / single-consumer ring buffer.
+
+  Used to hand samples and alerts from the sensing task (producer, core 1)
+  to the network task (consumer, core 0) without locks: each index is only
+  ever written by one side, so a pair of atomics is all the sync needed.
+  A full queue never blocks the producer; the item is dropped and counted.
+*/
+
+#ifndef __SPSCQUEUE_H__
+#define __SPSCQUEUE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+template <typename T, size_t N>
+class SpscQueue
+{
+  static_assert(N >= 2u && (N & (N - 1u)) == 0u, "SpscQueue capacity must be a power of two");
+
+  public:
+    SpscQueue() : _head(0u), _tail(0u), _highWater(0u), _dropped(0u) {}
+
+    /**
+     * @brief producer side, returns false (and counts a drop) when full
+     */
+    bool push(const T &item)
+    {
+      uint32_t head = _head.load(std::memory_order_relaxed);
+      uint32_t tail = _tail.load(std::memory_order_acquire);
+      if((head - tail) >= N)
+      {
+        _dropped.fetch_add(1u, std::memory_order_relaxed);
+        return false;
+      }
+      _buf[head & (N - 1u)] = item;
+      _head.store(head + 1u, std::memory_order_release);
+      uint32_t used = head + 1u - tail;
+      if(used > _highWater.load(std::memory_order_relaxed))
+      {
+        _highWater.store(used, std::memory_order_relaxed);
+      }
+      return true;
+    }
+
+    /**
+     * @brief consumer side, returns false when empty
+     */
+    bool pop(T &item)
+    {
+      if(!peek(item))
+      {
+        return false;
+      }
+      _tail.store(_tail.load(std::memory_order_relaxed) + 1u, std::memory_order_release);
+      return true;
+    }
+
+    /**
+     * @brief consumer side, copies the oldest item without removing it
+     */
+    bool peek(T &item) const
+    {
+      uint32_t tail = _tail.load(std::memory_order_relaxed);
+      if(tail == _head.load(std::memory_order_acquire))
+      {
+        return false;
+      }
+      item = _buf[tail & (N - 1u)];
+      return true;
+    }
+
+    size_t size(void) const
+    {
+      return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+
+    size_t capacity(void) const { return N; }
+    size_t highWater(void) const { return _highWater.load(std::memory_order_relaxed); }
+    uint32_t dropped(void) const { return _dropped.load(std::memory_order_relaxed); }
+
+  private:
+    T _buf[N];
+    std::atomic<uint32_t> _head;      /* next slot to write, owned by the producer */
+    std::atomic<uint32_t> _tail;      /* next slot to read, owned by the consumer */
+    std::atomic<uint32_t> _highWater; /* deepest fill level seen */
+    std::atomic<uint32_t> _dropped;   /* pushes rejected because the queue was full */
+};
+
+#endif
@@ -0,0 +1,165 @@
+#include "TelemetryCodec.h"
+#include <math.h>
+
+/**
+ *   @brief little endian writer that stops at the end of the buffer
+ */
+class FrameWriter
+{
+  public:
+    FrameWriter(uint8_t *buf, size_t cap) : _buf(buf), _cap(cap), _len(0u), _overflow(false) {}
+    void u8(uint8_t v)
+    {
+      if(_len >= _cap)
+      {
+        _overflow = true;
+        return;
+      }
+      _buf[_len++] = v;
+    }
+    void u16(uint16_t v) { u8((uint8_t)v); u8((uint8_t)(v >> 8)); }
+    void u32(uint32_t v) { u16((uint16_t)v); u16((uint16_t)(v >> 16)); }
+    void u64(uint64_t v) { u32((uint32_t)v); u32((uint32_t)(v >> 32)); }
+    /* fixed point with rounding, saturated to the int16 range */
+    void fx16(float v, float scale)
+    {
+      float x = roundf(v * scale);
+      if(!(x > -32768.f)) x = -32768.f;   /* also catches NaN */
+      if(x > 32767.f) x = 32767.f;
+      u16((uint16_t)(int16_t)x);
+    }
+    void ufx16(float v, float scale)
+    {
+      float x = roundf(v * scale);
+      if(!(x > 0.f)) x = 0.f;
+      if(x > 65535.f) x = 65535.f;
+      u16((uint16_t)x);
+    }
+    size_t length(void) const { return _overflow ? 0u : _len; }
+    const uint8_t *data(void) const { return _buf; }
+  private:
+    uint8_t *_buf;
+    size_t _cap;
+    size_t _len;
+    bool _overflow;
+};
+
+/* same resolution as the sample fields; light is halved to fit the int16 range */
+const float TELEMETRY_AGG_SCALE[AGG_CHANNELS] =
+{
+  1.f, 1.f, 1.f, 1.f, 10.f, 100.f, 10.f, 100.f, 1.f, 1.f, 0.5f
+};
+
+/**
+ *   @brief CRC-16/CCITT-FALSE: poly 0x1021, init 0xFFFF, no reflection
+ */
+uint16_t telemetryCrc16(const uint8_t *data, size_t len)
+{
+  uint16_t crc = 0xFFFFu;
+  for(size_t n = 0u; n < len; n++)
+  {
+    crc ^= (uint16_t)data[n] << 8;
+    for(uint8_t bit = 0u; bit < 8u; bit++)
+    {
+      crc = (crc & 0x8000u) ? (uint16_t)((crc << 1) ^ 0x1021u) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+/**
+ *
+ */
+size_t encodeTelemetryBinary(const TelemetrySample &s, const MessageStamp &stamp, uint8_t *buf, size_t cap)
+{
+  FrameWriter w(buf, cap);
+  uint8_t flags = 0u;
+  if(s.env.baroTime)  flags |= TELEMETRY_ENV_BARO;
+  if(s.env.humTime)   flags |= TELEMETRY_ENV_HUM;
+  if(s.env.airTime)   flags |= TELEMETRY_ENV_AIR;
+  if(s.env.lightTime) flags |= TELEMETRY_ENV_LIGHT;
+  if(!s.imu)          flags |= TELEMETRY_FLAG_NO_IMU;
+  if(stamp.stored)    flags |= TELEMETRY_FLAG_STORED;
+
+  w.u8(TELEMETRY_BIN_MAGIC0);
+  w.u8(TELEMETRY_BIN_MAGIC1);
+  w.u8(TELEMETRY_BIN_VERSION);
+  w.u8(TELEMETRY_BIN_SAMPLE);
+  w.u32((uint32_t)s.time);
+  w.u8(flags);
+
+  w.fx16(s.ax, 1.f);
+  w.fx16(s.ay, 1.f);
+  w.fx16(s.az, 1.f);
+  w.fx16(s.netAcc, 1.f);
+  w.fx16(s.gx, 10.f);
+  w.fx16(s.gy, 10.f);
+  w.fx16(s.gz, 10.f);
+  w.fx16(s.gyroMag, 10.f);
+  w.fx16(s.tx, 100.f);
+  w.fx16(s.ty, 100.f);
+  w.fx16(s.tz, 100.f);
+  w.fx16(s.tempC, 100.f);
+  w.fx16(s.thresTemp, 100.f);
+
+  if(flags & TELEMETRY_ENV_BARO)
+  {
+    w.ufx16(s.env.pressureHpa, 10.f);
+    w.fx16(s.env.baroTempC, 100.f);
+  }
+  if(flags & TELEMETRY_ENV_HUM)
+  {
+    w.ufx16(s.env.humidity, 100.f);
+    w.fx16(s.env.humTempC, 100.f);
+  }
+  if(flags & TELEMETRY_ENV_AIR)
+  {
+    w.u16(s.env.co2);
+    w.u16(s.env.tvoc);
+  }
+  if(flags & TELEMETRY_ENV_LIGHT)
+  {
+    w.u16(s.env.ambientLight);
+    w.u8(s.env.proximity);
+  }
+
+  w.u32(stamp.seq);
+  w.u64(stamp.wallMs);
+  w.u32(stamp.queuedMs);
+
+  uint16_t mask = 0u;
+  for(uint8_t n = 0u; n < AGG_CHANNELS; n++)
+  {
+    if(s.agg.ch[n].count)
+    {
+      mask |= (uint16_t)(1u << n);
+    }
+  }
+  w.u32((uint32_t)(s.time - s.agg.startMs));
+  w.u16(mask);
+  for(uint8_t n = 0u; n < AGG_CHANNELS; n++)
+  {
+    const RunningStats &st = s.agg.ch[n];
+    if(st.count == 0u)
+    {
+      continue;
+    }
+    float scale = TELEMETRY_AGG_SCALE[n];
+    w.u16(st.count > 0xFFFFu ? 0xFFFFu : (uint16_t)st.count);
+    w.fx16(st.min, scale);
+    w.fx16(st.max, scale);
+    w.fx16(st.mean, scale);
+    w.ufx16(st.stddev(), scale);
+    w.u16(st.over > 0xFFFFu ? 0xFFFFu : (uint16_t)st.over);
+  }
+
+  size_t len = w.length();
+  if((len == 0u) || (len + 2u > cap))
+  {
+    return 0u;
+  }
+  uint16_t crc = telemetryCrc16(buf, len);
+  buf[len++] = (uint8_t)crc;
+  buf[len++] = (uint8_t)(crc >> 8);
+  return len;
+}
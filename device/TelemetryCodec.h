@@ -0,0 +1,102 @@
+/*
+  Compact binary encoding of the sensor telemetry, alternative to JSON.
+
+  Frame layout (version 3, all fields little endian):
+
+    0   'M' 'T'             magic
+    2   u8   version         TELEMETRY_BIN_VERSION
+    3   u8   type            TELEMETRY_BIN_SAMPLE
+    4   u32  time            ms since boot at sampling
+    8   u8   flags           bit0 baro, bit1 humidity, bit2 air, bit3 light,
+                             bit6 no IMU (acc, gyro and tilt carry nothing),
+                             bit7 stored (went through the flash queue)
+    9   i16  acc x,y,z,net   cm/s^2
+   17   i16  gyro x,y,z,mag  0.1 deg/s
+   25   i16  tilt x,y,z      0.01 deg
+   31   i16  temp, thresTemp 0.01 degC
+   35   env blocks in flag order, only those flagged:
+          baro   u16 pressure 0.1 hPa, i16 temp 0.01 degC
+          hum    u16 humidity 0.01 %RH, i16 temp 0.01 degC
+          air    u16 eCO2 ppm, u16 TVOC ppb
+          light  u16 ambient light, u8 proximity
+        u32  seq             per topic sequence number          (version 2)
+        u64  wall time       Unix ms of the sample, 0 = no SNTP  (version 2)
+        u32  queued          ms from sample to encoding          (version 2)
+        u32  window ms       span of the aggregates              (version 3)
+        u16  channel mask    bit n: AggChannel n has samples     (version 3)
+        per flagged channel, in channel order                    (version 3)
+             u16 n, i16 min, i16 max, i16 mean, u16 std, u16 over
+             in the channel's unit times TELEMETRY_AGG_SCALE[n]
+    n   u16  CRC-16/CCITT-FALSE over every byte before it
+
+  The aggregate block carries the same window (TelemetrySample::agg) as
+  the JSON "agg" object. Values outside a field's range saturate. A decoder rejects unknown
+  versions and bad CRCs; new fields only ever get appended under a new
+  version. The ingest side decoder is backend/app/telemetry_codec.py.
+
+  Frames go out on baby/<id>/sensor/bin, never on the JSON sensor topic, so
+  JSON subscribers are not handed bytes they cannot parse. Both share the
+  sensor sequence numbers; frames flagged stored have a sequence of their own.
+*/
+
+#ifndef __TELEMETRYCODEC_H__
+#define __TELEMETRYCODEC_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include "SensorScheduler.h"
+#include "WindowStats.h"
+
+#define TELEMETRY_BIN_MAGIC0    'M'
+#define TELEMETRY_BIN_MAGIC1    'T'
+#define TELEMETRY_BIN_VERSION   3u
+#define TELEMETRY_BIN_SAMPLE    1u
+#define TELEMETRY_BIN_MAX       206u    /* largest version 3 sample frame: 68 + 6 + 11 channels x 12 */
+
+#define TELEMETRY_ENV_BARO      0x01u
+#define TELEMETRY_ENV_HUM       0x02u
+#define TELEMETRY_ENV_AIR       0x04u
+#define TELEMETRY_ENV_LIGHT     0x08u
+#define TELEMETRY_FLAG_NO_IMU   0x40u
+#define TELEMETRY_FLAG_STORED   0x80u
+
+enum TelemetryFormat : uint32_t
+{
+  TELEMETRY_JSON = 0,
+  TELEMETRY_BINARY = 1
+};
+
+/*!
+ * One published telemetry sample, handed from the sensing to the network task
+ */
+struct TelemetrySample {
+  unsigned long time;
+  float ax, ay, az, netAcc;
+  float gx, gy, gz, gyroMag;
+  float tx, ty, tz;
+  float tempC;
+  float thresTemp;
+  envReadings_t env;
+  WindowStats agg;      /**< everything since the previous sample was published */
+  uint8_t reason;       /**< PublishReason that triggered this sample */
+  bool imu;             /**< false: environment only, tempC from the slow boards */
+};
+
+/*!
+ * Tracing fields of one published message, filled in by the network task
+ */
+struct MessageStamp {
+  uint32_t seq;         /**< per topic, +1 per message */
+  uint64_t wallMs;      /**< Unix time of the sample in ms, 0 until SNTP has synced */
+  uint32_t queuedMs;    /**< sample to encoding for publish (or for the flash queue) */
+  bool stored;          /**< encoded for the flash queue */
+};
+
+/* fixed point scale of each aggregate channel in the binary frame, matches backend/app/telemetry_codec.py */
+extern const float TELEMETRY_AGG_SCALE[AGG_CHANNELS];
+
+/* returns the frame length, 0 if cap is too small */
+size_t encodeTelemetryBinary(const TelemetrySample &s, const MessageStamp &stamp, uint8_t *buf, size_t cap);
+uint16_t telemetryCrc16(const uint8_t *data, size_t len);
+
+#endif
@@ -0,0 +1,442 @@
+#include "TlsClient.h"
+#include <string.h>
+#include <mbedtls/md.h>
+#include <mbedtls/net_sockets.h>
+#include <mbedtls/version.h>
+
+/* session fields went private in mbedTLS 3 */
+#if MBEDTLS_VERSION_MAJOR >= 3
+#define TLS_SESSION_FIELD(s, f)   ((s).MBEDTLS_PRIVATE(f))
+#else
+#define TLS_SESSION_FIELD(s, f)   ((s).f)
+#endif
+
+#define TLS_MASTER_BYTES    48u
+
+/**
+ *
+ */
+TlsClient::TlsClient()
+{
+  _caPem          = NULL;
+  _pinFingerprint = false;
+  _configured     = false;
+  _sslActive      = false;
+  _haveSession    = false;
+  _peeked         = -1;
+  _timeoutMs      = TLS_HANDSHAKE_TIMEOUT_MS;
+  memset(_fingerprint, 0, sizeof(_fingerprint));
+  memset(&_stats, 0, sizeof(_stats));
+  mbedtls_ssl_config_init(&_conf);
+  mbedtls_x509_crt_init(&_ca);
+  mbedtls_entropy_init(&_entropy);
+  mbedtls_ctr_drbg_init(&_drbg);
+  mbedtls_ssl_session_init(&_session);
+}
+
+/**
+ *
+ */
+TlsClient::~TlsClient()
+{
+  stop();
+  mbedtls_ssl_session_free(&_session);
+  mbedtls_ctr_drbg_free(&_drbg);
+  mbedtls_entropy_free(&_entropy);
+  mbedtls_x509_crt_free(&_ca);
+  mbedtls_ssl_config_free(&_conf);
+}
+
+/**
+ *
+ */
+void TlsClient::setFingerprint(const uint8_t *sha256)
+{
+  memcpy(_fingerprint, sha256, TLS_FINGERPRINT_BYTES);
+  _pinFingerprint = true;
+}
+
+/**
+ *
+ */
+void TlsClient::clearSession(void)
+{
+  mbedtls_ssl_session_free(&_session);
+  mbedtls_ssl_session_init(&_session);
+  _haveSession = false;
+}
+
+/**
+ *
+ */
+int TlsClient::connect(IPAddress ip, uint16_t port)
+{
+  return connect(ip.toString().c_str(), port);
+}
+
+/**
+ *   @brief 1 on success, 0 on failure (stats().lastError tells why)
+ */
+int TlsClient::connect(const char *host, uint16_t port)
+{
+  stop();
+  if(configure() == false)
+  {
+    return 0;
+  }
+
+  uint32_t start = millis();
+  if(_tcp.connect(host, port) == 0)
+  {
+    fail(MBEDTLS_ERR_NET_CONNECT_FAILED);
+    return 0;
+  }
+  _stats.lastTcpMs = millis() - start;
+
+  int ret = handshake(host);
+  if(ret != 0)
+  {
+    stop();
+    fail(ret);
+    return 0;
+  }
+  return 1;
+}
+
+/**
+ *   @brief one-time setup of RNG, trust anchors and session tickets
+ */
+bool TlsClient::configure(void)
+{
+  if(_configured)
+  {
+    return true;
+  }
+  if((_caPem == NULL) && (_pinFingerprint == false))
+  {
+    fail(MBEDTLS_ERR_SSL_CA_CHAIN_REQUIRED);
+    return false;
+  }
+
+  static const char pers[] = "myosa-tls";
+  int ret = mbedtls_ctr_drbg_seed(&_drbg, mbedtls_entropy_func, &_entropy,
+                                  (const unsigned char *)pers, sizeof(pers) - 1u);
+  if(ret == 0)
+  {
+    ret = mbedtls_ssl_config_defaults(&_conf, MBEDTLS_SSL_IS_CLIENT,
+                                      MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT);
+  }
+  if((ret == 0) && (_caPem != NULL))
+  {
+    ret = mbedtls_x509_crt_parse(&_ca, (const unsigned char *)_caPem, strlen(_caPem) + 1u);
+  }
+  if(ret != 0)
+  {
+    fail(ret);
+    return false;
+  }
+
+  mbedtls_ssl_conf_rng(&_conf, mbedtls_ctr_drbg_random, &_drbg);
+  if(_caPem != NULL)
+  {
+    mbedtls_ssl_conf_ca_chain(&_conf, &_ca, NULL);
+    mbedtls_ssl_conf_authmode(&_conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+  }
+  else
+  {
+    /* fingerprint only: the chain is not checked, the pin is */
+    mbedtls_ssl_conf_authmode(&_conf, MBEDTLS_SSL_VERIFY_OPTIONAL);
+  }
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+  mbedtls_ssl_conf_session_tickets(&_conf, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#endif
+  _configured = true;
+  return true;
+}
+
+/**
+ *   @brief offers the cached session; a resumed handshake keeps its master secret,
+ *          which is how it is told apart from a full one for ID and ticket resumption alike
+ */
+int TlsClient::handshake(const char *host)
+{
+  mbedtls_ssl_init(&_ssl);
+  _sslActive = true;
+  int ret = mbedtls_ssl_setup(&_ssl, &_conf);
+  if(ret == 0)
+  {
+    ret = mbedtls_ssl_set_hostname(&_ssl, host);
+  }
+  if(ret != 0)
+  {
+    return ret;
+  }
+  mbedtls_ssl_set_bio(&_ssl, &_tcp, bioSend, bioRecv, NULL);
+
+  uint8_t offered[TLS_MASTER_BYTES];
+  bool offering = _haveSession && (mbedtls_ssl_set_session(&_ssl, &_session) == 0);
+  if(offering)
+  {
+    memcpy(offered, TLS_SESSION_FIELD(_session, master), TLS_MASTER_BYTES);
+  }
+
+  uint32_t start = millis();
+  while((ret = mbedtls_ssl_handshake(&_ssl)) != 0)
+  {
+    if((ret != MBEDTLS_ERR_SSL_WANT_READ) && (ret != MBEDTLS_ERR_SSL_WANT_WRITE))
+    {
+      break;
+    }
+    if(millis() - start >= _timeoutMs)
+    {
+      ret = MBEDTLS_ERR_SSL_TIMEOUT;
+      break;
+    }
+    delay(1);
+  }
+  uint32_t took = millis() - start;
+  if(ret != 0)
+  {
+    /* the broker may have dropped the session, start clean next time */
+    clearSession();
+    return ret;
+  }
+
+  clearSession();
+  _haveSession = (mbedtls_ssl_get_session(&_ssl, &_session) == 0);
+  bool resumed = offering && _haveSession &&
+                 (memcmp(offered, TLS_SESSION_FIELD(_session, master), TLS_MASTER_BYTES) == 0);
+
+  /* a resumed session was pinned when it was first established */
+  if((resumed == false) && _pinFingerprint && (fingerprintMatches() == false))
+  {
+    clearSession();
+    return MBEDTLS_ERR_X509_CERT_VERIFY_FAILED;
+  }
+
+  _stats.handshakes++;
+  _stats.lastMs = took;
+  _stats.lastResumed = resumed;
+  _stats.lastError = 0;
+  if(took > _stats.maxMs)
+  {
+    _stats.maxMs = took;
+  }
+  if(resumed)
+  {
+    _stats.resumed++;
+    _stats.resumedMsTotal += took;
+  }
+  else
+  {
+    _stats.fullMsTotal += took;
+  }
+  return 0;
+}
+
+/**
+ *
+ */
+bool TlsClient::fingerprintMatches(void)
+{
+  const mbedtls_x509_crt *crt = mbedtls_ssl_get_peer_cert(&_ssl);
+  if(crt == NULL)
+  {
+    return false;
+  }
+  uint8_t digest[TLS_FINGERPRINT_BYTES];
+  if(mbedtls_md(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), crt->raw.p, crt->raw.len, digest) != 0)
+  {
+    return false;
+  }
+  return memcmp(digest, _fingerprint, TLS_FINGERPRINT_BYTES) == 0;
+}
+
+/**
+ *
+ */
+void TlsClient::fail(int err)
+{
+  _stats.failures++;
+  _stats.lastError = err;
+}
+
+/**
+ *   @brief blocks until everything is written or the handshake timeout passes
+ */
+size_t TlsClient::write(const uint8_t *buf, size_t size)
+{
+  if(_sslActive == false)
+  {
+    return 0u;
+  }
+  size_t done = 0u;
+  uint32_t start = millis();
+  while(done < size)
+  {
+    int ret = mbedtls_ssl_write(&_ssl, buf + done, size - done);
+    if(ret > 0)
+    {
+      done += ret;
+    }
+    else if(((ret == MBEDTLS_ERR_SSL_WANT_READ) || (ret == MBEDTLS_ERR_SSL_WANT_WRITE)) &&
+            (millis() - start < _timeoutMs))
+    {
+      delay(1);
+    }
+    else
+    {
+      break;
+    }
+  }
+  return done;
+}
+
+/**
+ *
+ */
+size_t TlsClient::write(uint8_t b)
+{
+  return write(&b, 1u);
+}
+
+/**
+ *   @brief a zero length read processes pending records without taking data
+ */
+int TlsClient::available(void)
+{
+  int peeked = (_peeked >= 0) ? 1 : 0;
+  if(_sslActive == false)
+  {
+    return peeked;
+  }
+  int ret = mbedtls_ssl_read(&_ssl, NULL, 0);
+  if((ret < 0) && (ret != MBEDTLS_ERR_SSL_WANT_READ) && (ret != MBEDTLS_ERR_SSL_WANT_WRITE))
+  {
+    stop();
+    return peeked;
+  }
+  return peeked + (int)mbedtls_ssl_get_bytes_avail(&_ssl);
+}
+
+/**
+ *
+ */
+int TlsClient::read(uint8_t *buf, size_t size)
+{
+  if(size == 0u)
+  {
+    return 0;
+  }
+  int got = 0;
+  if(_peeked >= 0)
+  {
+    buf[0] = (uint8_t)_peeked;
+    _peeked = -1;
+    got = 1;
+    buf++;
+    size--;
+    if(size == 0u)
+    {
+      return got;
+    }
+  }
+  if(_sslActive == false)
+  {
+    return (got > 0) ? got : -1;
+  }
+  int ret = mbedtls_ssl_read(&_ssl, buf, size);
+  if(ret > 0)
+  {
+    return got + ret;
+  }
+  if((ret != MBEDTLS_ERR_SSL_WANT_READ) && (ret != MBEDTLS_ERR_SSL_WANT_WRITE))
+  {
+    /* 0 or close notify: the broker closed the connection */
+    stop();
+  }
+  return (got > 0) ? got : -1;
+}
+
+/**
+ *
+ */
+int TlsClient::read(void)
+{
+  uint8_t b;
+  return (read(&b, 1u) == 1) ? b : -1;
+}
+
+/**
+ *
+ */
+int TlsClient::peek(void)
+{
+  if(_peeked < 0)
+  {
+    _peeked = read();
+  }
+  return _peeked;
+}
+
+/**
+ *   @brief records are handed to the socket as they are written
+ */
+void TlsClient::flush(void)
+{
+}
+
+/**
+ *
+ */
+void TlsClient::stop(void)
+{
+  if(_sslActive)
+  {
+    mbedtls_ssl_close_notify(&_ssl);
+    mbedtls_ssl_free(&_ssl);
+    _sslActive = false;
+  }
+  _tcp.stop();
+  _peeked = -1;
+}
+
+/**
+ *
+ */
+uint8_t TlsClient::connected(void)
+{
+  if(_sslActive == false)
+  {
+    return 0u;
+  }
+  return (_tcp.connected() || (mbedtls_ssl_get_bytes_avail(&_ssl) > 0u) || (_peeked >= 0)) ? 1u : 0u;
+}
+
+/**
+ *   @brief mbedTLS send callback, ctx is the WiFiClient
+ */
+int TlsClient::bioSend(void *ctx, const unsigned char *buf, size_t len)
+{
+  WiFiClient *tcp = (WiFiClient *)ctx;
+  if(tcp->connected() == 0u)
+  {
+    return MBEDTLS_ERR_NET_CONN_RESET;
+  }
+  int n = tcp->write(buf, len);
+  return (n > 0) ? n : MBEDTLS_ERR_SSL_WANT_WRITE;
+}
+
+/**
+ *   @brief mbedTLS receive callback, never blocks
+ */
+int TlsClient::bioRecv(void *ctx, unsigned char *buf, size_t len)
+{
+  WiFiClient *tcp = (WiFiClient *)ctx;
+  if(tcp->available() == 0)
+  {
+    return tcp->connected() ? MBEDTLS_ERR_SSL_WANT_READ : MBEDTLS_ERR_NET_CONN_RESET;
+  }
+  int n = tcp->read(buf, len);
+  return (n > 0) ? n : MBEDTLS_ERR_SSL_WANT_READ;
+}
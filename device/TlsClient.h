@@ -0,0 +1,104 @@
+/*
+  TLS client for the MQTT link with session resumption and a pinned broker.
+
+  WiFiClientSecure runs a full handshake on every connect and has no way
+  to offer a previous session. This client drives mbedTLS over a plain
+  WiFiClient itself, keeps the session of the last successful handshake
+  (ID and, where the broker issues one, ticket) and offers it on the next
+  connect. A resumed handshake skips the certificate exchange and the
+  public key operations: one round trip less and a fraction of the CPU.
+
+  The broker is always authenticated, there is no insecure mode:
+
+    - setCACert(): chain verified against the CA, host name checked
+    - setFingerprint(): SHA-256 of the broker certificate (DER) must match
+
+  Either or both may be set; connect() fails when neither is.
+
+  Every handshake is timed; stats() tells full from resumed ones.
+  Written against the mbedTLS 2.28 API of arduino-esp32 2.x.
+*/
+
+#ifndef __TLSCLIENT_H__
+#define __TLSCLIENT_H__
+
+#include <stdint.h>
+#include <Arduino.h>
+#include <Client.h>
+#include <WiFi.h>
+#include <mbedtls/ssl.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/ctr_drbg.h>
+#include <mbedtls/x509_crt.h>
+
+#define TLS_FINGERPRINT_BYTES     32u
+#define TLS_HANDSHAKE_TIMEOUT_MS  10000u
+
+typedef struct
+{
+  uint32_t handshakes;        /**< successful, full or resumed */
+  uint32_t resumed;
+  uint32_t failures;          /**< TCP, handshake or pin failures */
+  uint32_t lastTcpMs;         /**< TCP connect of the last success */
+  uint32_t lastMs;            /**< handshake of the last success */
+  bool lastResumed;
+  uint32_t fullMsTotal;       /**< for the means, full handshakes */
+  uint32_t resumedMsTotal;
+  uint32_t maxMs;
+  int32_t lastError;          /**< mbedTLS error code of the last failure, 0 = none */
+}tlsStats_t;
+
+class TlsClient : public Client
+{
+  public:
+    TlsClient();
+    ~TlsClient();
+    /* PEM, must stay valid while the client is used; set before the first connect() */
+    void setCACert(const char *pem) { _caPem = pem; }
+    /* SHA-256 over the broker certificate DER, 32 bytes; set before the first connect() */
+    void setFingerprint(const uint8_t *sha256);
+    void setHandshakeTimeout(uint32_t ms) { _timeoutMs = ms; }
+    /* forget the cached session, the next connect does a full handshake */
+    void clearSession(void);
+    const tlsStats_t &stats(void) const { return _stats; }
+
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(const char *host, uint16_t port) override;
+    size_t write(uint8_t b) override;
+    size_t write(const uint8_t *buf, size_t size) override;
+    int available(void) override;
+    int read(void) override;
+    int read(uint8_t *buf, size_t size) override;
+    int peek(void) override;
+    void flush(void) override;
+    void stop(void) override;
+    uint8_t connected(void) override;
+    operator bool() override { return connected() != 0u; }
+  private:
+    WiFiClient _tcp;
+    mbedtls_ssl_context _ssl;
+    mbedtls_ssl_config _conf;
+    mbedtls_x509_crt _ca;
+    mbedtls_entropy_context _entropy;
+    mbedtls_ctr_drbg_context _drbg;
+    mbedtls_ssl_session _session;
+    const char *_caPem;
+    uint8_t _fingerprint[TLS_FINGERPRINT_BYTES];
+    bool _pinFingerprint;
+    bool _configured;
+    bool _sslActive;
+    bool _haveSession;
+    int _peeked;                /**< byte taken by peek(), -1 = none */
+    uint32_t _timeoutMs;
+    tlsStats_t _stats;
+
+    bool configure(void);
+    int handshake(const char *host);
+    bool fingerprintMatches(void);
+    void fail(int err);
+
+    static int bioSend(void *ctx, const unsigned char *buf, size_t len);
+    static int bioRecv(void *ctx, unsigned char *buf, size_t len);
+};
+
+#endif
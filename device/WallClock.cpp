@@ -0,0 +1,34 @@
+#include "WallClock.h"
+#include <sys/time.h>
+#include <time.h>
+
+/**
+ *
+ */
+void wallClockBegin(const char *server1, const char *server2)
+{
+  configTime(0, 0, server1, server2);
+}
+
+/**
+ *
+ */
+bool wallClockSynced(void)
+{
+  return time(NULL) > (time_t)WALLCLOCK_VALID_AFTER;
+}
+
+/**
+ *   @brief reads the clock now and steps back by the millis() elapsed since atMillis
+ */
+uint64_t wallClockMs(unsigned long atMillis)
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  unsigned long age = millis() - atMillis;
+  if(tv.tv_sec <= (time_t)WALLCLOCK_VALID_AFTER)
+  {
+    return 0u;
+  }
+  return (uint64_t)tv.tv_sec * 1000u + (uint64_t)(tv.tv_usec / 1000) - age;
+}
@@ -0,0 +1,25 @@
+/*
+  Wall-clock time from SNTP for stamping messages.
+
+  The firmware keeps working on millis(); wall time is only attached to
+  what leaves the device, so the backend can line device, broker and
+  ingest times up. Until the first SNTP answer arrives wallClockMs()
+  returns 0 and messages go out with their device time only. The SNTP
+  client keeps resyncing in the background (lwIP default: hourly).
+*/
+
+#ifndef __WALLCLOCK_H__
+#define __WALLCLOCK_H__
+
+#include <stdint.h>
+#include <Arduino.h>
+
+#define WALLCLOCK_VALID_AFTER   1700000000UL   /* s, anything earlier means not synced yet */
+
+/* start SNTP in UTC, once Wi-Fi is in station mode */
+void wallClockBegin(const char *server1, const char *server2);
+bool wallClockSynced(void);
+/* Unix time in ms at the given millis() reading, 0 until synced */
+uint64_t wallClockMs(unsigned long atMillis);
+
+#endif
@@ -0,0 +1,113 @@
+/*
+  Per-window aggregates of the telemetry channels.
+
+  The sensing task folds every sample into one RunningStats per channel
+  (Welford's update: O(1) time and memory per sample, numerically stable
+  for the long 100 Hz windows) and hands the whole set over with each
+  telemetry publish, then starts a new window. A publish therefore
+  describes everything that happened since the previous one, not just the
+  instant it was taken.
+*/
+
+#ifndef __WINDOWSTATS_H__
+#define __WINDOWSTATS_H__
+
+#include <stdint.h>
+#include <math.h>
+
+struct RunningStats
+{
+  uint32_t count;
+  uint32_t over;      /**< samples above the channel's threshold */
+  float mean;
+  float m2;           /**< sum of squared differences from the mean */
+  float min;
+  float max;
+
+  void reset(void)
+  {
+    count = 0u;
+    over = 0u;
+    mean = 0.f;
+    m2 = 0.f;
+    min = 0.f;
+    max = 0.f;
+  }
+
+  void add(float x)
+  {
+    if(count == 0u)
+    {
+      min = x;
+      max = x;
+    }
+    else
+    {
+      if(x < min) min = x;
+      if(x > max) max = x;
+    }
+    count++;
+    float delta = x - mean;
+    mean += delta / (float)count;
+    m2 += delta * (x - mean);
+  }
+
+  void add(float x, float threshold)
+  {
+    add(x);
+    if(x > threshold)
+    {
+      over++;
+    }
+  }
+
+  /* population standard deviation of the window */
+  float stddev(void) const
+  {
+    return (count > 1u) ? sqrtf(m2 / (float)count) : 0.f;
+  }
+};
+
+enum AggChannel : uint8_t
+{
+  AGG_ACC_X,          /* filtered, cm/s^2 */
+  AGG_ACC_Y,
+  AGG_ACC_Z,
+  AGG_NET_ACC,        /* over = samples above IMPACT_G */
+  AGG_GYRO,           /* magnitude, over = samples above GYRO_SPIKE */
+  AGG_TEMP,           /* over = samples above the temperature threshold */
+  AGG_PRESSURE,       /* slow boards: one entry per new reading */
+  AGG_HUMIDITY,
+  AGG_CO2,
+  AGG_TVOC,
+  AGG_LIGHT,
+  AGG_CHANNELS
+};
+
+static const char *const AGG_CHANNEL_NAMES[AGG_CHANNELS] =
+{
+  "acc_x", "acc_y", "acc_z", "net", "gyro", "temp", "pressure", "humidity", "co2", "tvoc", "light"
+};
+
+/* decimals of min/max/mean/std in the JSON telemetry, the resolution of each sensor */
+static const uint8_t AGG_CHANNEL_DECIMALS[AGG_CHANNELS] =
+{
+  1u, 1u, 1u, 1u, 1u, 2u, 2u, 1u, 0u, 0u, 0u
+};
+
+struct WindowStats
+{
+  uint32_t startMs;
+  RunningStats ch[AGG_CHANNELS];
+
+  void reset(uint32_t nowMs)
+  {
+    startMs = nowMs;
+    for(uint8_t n = 0u; n < AGG_CHANNELS; n++)
+    {
+      ch[n].reset();
+    }
+  }
+};
+
+#endif
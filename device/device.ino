@@ -1,17 +1,37 @@
 #include <WiFi.h>
-#include <WiFiClientSecure.h>
 #include <MQTT.h>
-#include <Wire.h>
+#include <I2cBus.h>
 #include <AccelAndGyro.h>
 #include <BarometricPressure.h>
+#include <TempAndHumidity.h>
+#include <AirQuality.h>
+#include <LightProximityAndGesture.h>
 #include <ArduinoJson.h>
-#include <Preferences.h>
+#include <esp_timer.h>
+#include <LittleFS.h>
+#include "SpscQueue.h"
+#include "SensorScheduler.h"
+#include "LoopTiming.h"
+#include "Profiler.h"
+#include "ConfigStore.h"
+#include "I2cQueue.h"
+#include "TelemetryCodec.h"
+#include "ImuBatch.h"
+#include "WindowStats.h"
+#include "PublishPolicy.h"
+#include "FlashQueue.h"
+#include "TlsClient.h"
+#include "WallClock.h"
+#include "DelayHistogram.h"
+#include "DetectionConfig.h"
+#include "RadioPower.h"
+#include "BoardScan.h"
 
 
 /* =========================================================
    ALERT COOLDOWN (CHANGE HERE)
    ========================================================= */
-const unsigned long ALERT_COOLDOWN = 2 * 60 * 1000UL; // 2 minutes
+const unsigned long ALERT_COOLDOWN = 2 * 60 * 1000UL; // 2 minutes (also repeat period of the last post-fall stage)
 
 unsigned long lastFallAlertTime = 0;
 unsigned long lastTempAlertTime = 0;
@@ -20,12 +40,26 @@ unsigned long lastTempAlertTime = 0;
 /* =========================================================
    OBJECTS
    ========================================================= */
-Preferences prefs;
-AccelAndGyro Ag;
-BarometricPressure Pr(ULTRA_HIGH_RESOLUTION);
+ConfigStore config("config");
+I2cQueue i2cBus;
+BoardScan boards;
+/* created by setup() for the boards the scan identified; NULL unless begin() succeeded */
+AccelAndGyro* Ag = NULL;
+BarometricPressure* Pr = NULL;
+TempAndHumidity* Th = NULL;
+AirQuality* Aq = NULL;
+LightProximityAndGesture* Lp = NULL;
 
-WiFiClientSecure net;
-MQTTClient client(512);
+TlsClient net;             // resumes the previous TLS session on reconnect
+/* largest payload: JSON telemetry with every board and all eleven aggregates,
+   1141 bytes at worst (10 digit counts and stamps, floats at their fixed decimals) */
+const size_t TELEMETRY_JSON_MAX = 1280;
+/* post_fall_inactivity with every field and the stamp is 296 bytes at worst;
+   building or parsing it takes 15 members plus the copied strings */
+const size_t ALERT_JSON_MAX = 384;
+const size_t ALERT_DOC_SIZE = 512;
+const int MQTT_BUFFER = TELEMETRY_JSON_MAX + 128;   // plus fixed header, topic and packet id
+MQTTClient client(MQTT_BUFFER);
 
 /* =========================================================
    WIFI / MQTT
@@ -38,40 +72,368 @@ const int mqtt_port = 8883;
 const char* mqtt_user = "hivemq.webclient.1766833151037";
 const char* mqtt_pass = "f7TEHZ8>Ld#vy,R6j5%e";
 
+const char* ntp_server1 = "pool.ntp.org";
+const char* ntp_server2 = "time.google.com";
+
+/* broker trust anchor: HiveMQ Cloud serves a Let's Encrypt chain. For a
+   local test broker put its CA here, or pin the broker certificate with
+   net.setFingerprint() (SHA-256 of the DER) instead */
+const char* mqtt_ca_cert = R"PEM(
+-----BEGIN CERTIFICATE-----
+MIIFazCCA1OgAwIBAgIRAIIQz7DSQONZRGPgu2OCiwAwDQYJKoZIhvcNAQELBQAw
+TzELMAkGA1UEBhMCVVMxKTAnBgNVBAoTIEludGVybmV0IFNlY3VyaXR5IFJlc2Vh
+cmNoIEdyb3VwMRUwEwYDVQQDEwxJU1JHIFJvb3QgWDEwHhcNMTUwNjA0MTEwNDM4
+WhcNMzUwNjA0MTEwNDM4WjBPMQswCQYDVQQGEwJVUzEpMCcGA1UEChMgSW50ZXJu
+ZXQgU2VjdXJpdHkgUmVzZWFyY2ggR3JvdXAxFTATBgNVBAMTDElTUkcgUm9vdCBY
+MTCCAiIwDQYJKoZIhvcNAQEBBQADggIPADCCAgoCggIBAK3oJHP0FDfzm54rVygc
+h77ct984kIxuPOZXoHj3dcKi/vVqbvYATyjb3miGbESTtrFj/RQSa78f0uoxmyF+
+0TM8ukj13Xnfs7j/EvEhmkvBioZxaUpmZmyPfjxwv60pIgbz5MDmgK7iS4+3mX6U
+A5/TR5d8mUgjU+g4rk8Kb4Mu0UlXjIB0ttov0DiNewNwIRt18jA8+o+u3dpjq+sW
+T8KOEUt+zwvo/7V3LvSye0rgTBIlDHCNAymg4VMk7BPZ7hm/ELNKjD+Jo2FR3qyH
+B5T0Y3HsLuJvW5iB4YlcNHlsdu87kGJ55tukmi8mxdAQ4Q7e2RCOFvu396j3x+UC
+B5iPNgiV5+I3lg02dZ77DnKxHZu8A/lJBdiB3QW0KtZB6awBdpUKD9jf1b0SHzUv
+KBds0pjBqAlkd25HN7rOrFleaJ1/ctaJxQZBKT5ZPt0m9STJEadao0xAH0ahmbWn
+OlFuhjuefXKnEgV4We0+UXgVCwOPjdAvBbI+e0ocS3MFEvzG6uBQE3xDk3SzynTn
+jh8BCNAw1FtxNrQHusEwMFxIt4I7mKZ9YIqioymCzLq9gwQbooMDQaHWBfEbwrbw
+qHyGO0aoSCqI3Haadr8faqU9GY/rOPNk3sgrDQoo//fb4hVC1CLQJ13hef4Y53CI
+rU7m2Ys6xt0nUW7/vGT1M0NPAgMBAAGjQjBAMA4GA1UdDwEB/wQEAwIBBjAPBgNV
+HRMBAf8EBTADAQH/MB0GA1UdDgQWBBR5tFnme7bl5AFzgAiIyBpY9umbbjANBgkq
+hkiG9w0BAQsFAAOCAgEAVR9YqbyyqFDQDLHYGmkgJykIrGF1XIpu+ILlaS/V9lZL
+ubhzEFnTIZd+50xx+7LSYK05qAvqFyFWhfFQDlnrzuBZ6brJFe+GnY+EgPbk6ZGQ
+3BebYhtF8GaV0nxvwuo77x/Py9auJ/GpsMiu/X1+mvoiBOv/2X/qkSsisRcOj/KK
+NFtY2PwByVS5uCbMiogziUwthDyC3+6WVwW6LLv3xLfHTjuCvjHIInNzktHCgKQ5
+ORAzI4JMPJ+GslWYHb4phowim57iaztXOoJwTdwJx4nLCgdNbOhdjsnvzqvHu7Ur
+TkXWStAmzOVyyghqpZXjFaH3pO3JLF+l+/+sKAIuvtd7u+Nxe5AW0wdeRlN8NwdC
+jNPElpzVmbUq4JUagEiuTDkHzsxHpFKVK7q4+63SM1N95R1NbdWhscdCb+ZAJzVc
+oyi3B43njTOQ5yOf+1CceWxG1bQVs5ZufpsMljq4Ui0/1lvh+wjChP4kqKOJ2qxq
+4RgqsahDYVvTH9w7jXbyLeiNdd8XM2w9U/t7y0Ff/9yi0GE44Za4rF2LN9d11TPA
+mRGunUHBcnWEvgJBQl9nJEiU0Zsnvgc/ubhPgXRR4Xq37Z0j4r7g1SgEEzwxA57d
+emyPxgcYxn/eR44/KJ4EBs+lVDR3veyJm+kXQ99b21/+jh5Xos1AnX5iItreGCc=
+-----END CERTIFICATE-----
+)PEM";
+
 #define DEVICE_ID "device123"
+#define FIRMWARE_VERSION "1.6.0"
 #define TOPIC_SENSOR  "baby/" DEVICE_ID "/sensor"
+#define TOPIC_SENSOR_BIN "baby/" DEVICE_ID "/sensor/bin"   // binary frames, kept off the JSON topic
 #define TOPIC_ALERT   "baby/" DEVICE_ID "/alert"
 #define TOPIC_COMMAND "baby/" DEVICE_ID "/config"
+#define TOPIC_DIAG    "baby/" DEVICE_ID "/diag"
+#define TOPIC_IMU     "baby/" DEVICE_ID "/imu"
+#define TOPIC_LIVE    "baby/" DEVICE_ID "/live"
+#define TOPIC_CONFIG_ACK "baby/" DEVICE_ID "/config_ack"
+#define TOPIC_STATUS  "baby/" DEVICE_ID "/status"   // retained presence, last will when the session dies
+
+/* a full IMU or live batch goes out in one PUBLISH: fixed header, topic, packet id, frame */
+static_assert(5 + 2 + sizeof(TOPIC_IMU) - 1 + 2 + IMU_BATCH_BYTES <= MQTT_BUFFER, "IMU batch does not fit the MQTT buffer");
+static_assert(5 + 2 + sizeof(TOPIC_LIVE) - 1 + 2 + IMU_BATCH_BYTES <= MQTT_BUFFER, "live batch does not fit the MQTT buffer");
+
+/* registered as the last will: the broker publishes it, retained, when the
+   session ends without a DISCONNECT (power loss, reset, Wi-Fi gone) */
+const char STATUS_OFFLINE[] = "{\"state\":\"offline\",\"fw\":\"" FIRMWARE_VERSION "\"}";
+
+/* =========================================================
+   TASKS (sensing on APP core, network next to the Wi-Fi stack)
+   ========================================================= */
+const BaseType_t SENSING_CORE = 1;
+const BaseType_t NETWORK_CORE = 0;
+const UBaseType_t SENSING_PRIORITY = 5;
+const UBaseType_t NETWORK_PRIORITY = 2;
+const UBaseType_t I2C_PRIORITY = SENSING_PRIORITY + 1;   // picks a transfer up as soon as it is queued
+const uint32_t SENSING_STACK = 4096;
+const uint32_t NETWORK_STACK = 8192;
+const unsigned long NETWORK_POLL    = 10;     // ms between network task passes
+const unsigned long DIAG_INTERVAL   = 60000;
+
+/* =========================================================
+   RADIO DUTY CYCLE (modem sleep between aligned upload bursts)
+   ========================================================= */
+const uint8_t RADIO_AP_DTIM          = 1;       // DTIM period of the access point, in beacons
+const uint8_t RADIO_LISTEN_DTIMS     = 3;       // modem sleep wakes every 3rd DTIM, ~300 ms
+const unsigned long RADIO_BURST_MS   = 15000;   // deferred messages go out on these boundaries
+const unsigned long RADIO_POLL_MS    = 1000;    // client.loop() while dozing: commands, keepalive
+const unsigned long RADIO_LINGER_MS  = 100;     // awake after the last send, for the TCP ACKs
+const size_t RADIO_BURST_FILL        = 3;       // telemetry samples that start a burst early (flash takes over at 4)
+const int MQTT_KEEPALIVE_S           = 60;      // every PINGREQ wakes the radio; the will fires after 1.5x this
+
+/* =========================================================
+   STORE-AND-FORWARD (LittleFS, alerts and telemetry in separate lanes)
+   ========================================================= */
+const uint16_t STORE_SEGMENT_BYTES    = 4096;   // one flash block
+const uint16_t STORE_ALERT_SEGMENTS   = 16;     // 64 KB, some 300 alerts
+const uint16_t STORE_TEL_SEGMENTS     = 128;    // 512 KB, a night of heartbeats even as JSON
+const uint16_t STORE_DRAIN_BATCH      = 8;      // stored messages per network pass
+const uint16_t STORE_RECORD_MAX       = TELEMETRY_JSON_MAX;   // largest payload
+
+/* =========================================================
+   RECONNECT (exponential backoff with jitter)
+   ========================================================= */
+const unsigned long WIFI_CONNECT_TIMEOUT = 15000;
+const unsigned long BACKOFF_MIN = 500;
+const unsigned long BACKOFF_MAX = 60000;
+const int MQTT_COMMAND_TIMEOUT  = 2000;   // bounds each blocking lwmqtt call
+
+/* =========================================================
+   SAMPLE RATES
+   ========================================================= */
+const unsigned long SENSOR_INTERVAL   = 10;     // IMU, 100 Hz (default, "sensor_interval_ms")
+const unsigned long BARO_INTERVAL     = 500;    // BMP180, 2 Hz
+const unsigned long HUMIDITY_INTERVAL = 5000;   // Si7021, 0.2 Hz
+const unsigned long AIR_INTERVAL      = 1000;   // CCS811, 1 Hz (drive mode 1)
+const unsigned long LIGHT_INTERVAL    = 1000;   // APDS9960
+const uint32_t SLOW_SENSOR_BUDGET_US  = 2000;   // per IMU tick, after the IMU sample
+/* telemetry rate is change driven, see PublishPolicy (defaults: 2 s active/change, 60 s heartbeat) */
+const size_t IMU_BURST_BATCHES        = 8;      // full-rate IMU batches are sent in bursts of this many...
+const unsigned long IMU_BATCH_MAX_AGE = 5000;   // ...or once the oldest has waited this long
+
+/* live view ({"cmd":"live","seconds":N,"decimate":k} on TOPIC_COMMAND) */
+const uint32_t LIVE_MAX_SECONDS       = 300;
+const uint8_t LIVE_MAX_DECIMATE       = 8;      // 12.5 Hz
+const unsigned long LIVE_BATCH_MS     = 250;    // a live batch never holds back more than this
+const unsigned long LIVE_ENV_INTERVAL = 1000;
+const unsigned long LIVE_CHECK_MS     = 1000;   // headroom check period
+const float LIVE_MAX_SENSING_LOAD     = 70.0f;  // percent of the sensing core
 
 /* =========================================================
    BABY FALL THRESHOLDS (30cm+)
+   defaults; the values in use come from DetectionConfig
    ========================================================= */
 const float IMPACT_G       = 1.1f;
-const float IMPACT_SLOPE_G = 0.6f;
+const float IMPACT_SLOPE_G = 0.6f;     // rise of netAcc over SLOPE_SPAN
 const float GYRO_SPIKE     = 70.0f;
 const unsigned long FALL_COOLDOWN = 5000;
+const unsigned long SLOPE_SPAN    = 20;  // ms, the slope was tuned at 50 Hz
+const uint8_t SLOPE_LAG_MAX = SLOPE_SPAN / DETECTION_INTERVAL_MIN_MS;
+
+/* =========================================================
+   POST-FALL INACTIVITY MONITOR
+   ========================================================= */
+const unsigned long POST_FALL_WINDOW = 5 * 60 * 1000UL; // watch 5 minutes after an impact
+const unsigned long RECOVERY_HOLD    = 2000;            // movement needed to call it a recovery
+const float MOTION_TAU_MS  = 190.0f; // smoothing of the motion energy; 0.1 per tick at the 50 Hz it was tuned at
+const float GYRO_ENERGY_K  = 2.0f;   // weight of gyro change vs accel change
+const float STILL_ENERGY   = 15.0f;  // below this the wearer counts as still
+const float MOVE_ENERGY    = 60.0f;  // above this the wearer counts as moving
+
+/* stillness (ms) needed to raise each escalation level */
+const unsigned long INACTIVITY_STAGES[] = { 20000, 60000, 120000 };
+const uint8_t INACTIVITY_LEVELS = sizeof(INACTIVITY_STAGES) / sizeof(INACTIVITY_STAGES[0]);
 
 /* =========================================================
    FILTER
    ========================================================= */
-const float ALPHA = 0.25f;
+const float ALPHA = 0.134f;   // default; same ~70 ms time constant as 0.25 at the old 50 Hz
+
+/* MYOSA_TRACE channel ids */
+enum TraceId : uint8_t {
+  TRACE_NET_ACC = 1,    // x1000
+  TRACE_ACC_SLOPE,      // x1000
+  TRACE_GYRO_MAG        // x10, deg/s
+};
+
+/* =========================================================
+   QUEUES (sensing -> network)
+   ========================================================= */
+enum AlertKind : uint8_t {
+  ALERT_FALL_IMPACT,
+  ALERT_HIGH_TEMPERATURE,
+  ALERT_POST_FALL_INACTIVITY,
+  ALERT_FALL_RECOVERY
+};
+
+struct AlertEvent {
+  AlertKind kind;
+  uint8_t level;               // post-fall escalation level
+  bool final;                  // last post-fall word before the window closes
+  unsigned long time;          // millis() of the sample that raised it
+  float value;                 // severity score, temperature or motion energy
+  unsigned long stillMs;
+  unsigned long sinceFallMs;
+  uint32_t seq;                // per boot, set by queueAlert(); with the boot count the dedup key
+};
+
+/* TelemetrySample lives in TelemetryCodec.h */
+SpscQueue<AlertEvent, 16> alertQueue;
+SpscQueue<TelemetrySample, 8> telemetryQueue;
+SpscQueue<imuBatch_t, 16> imuBatchQueue;  // ~0.3-0.8 s of 100 Hz samples per batch
+SpscQueue<imuBatch_t, 4> liveQueue;       // live view batches, at most LIVE_BATCH_MS each
+
+/* what the RAM queues could not deliver, kept across outages and resets (network task only) */
+FlashQueue alertStore("/qa", STORE_ALERT_SEGMENTS, STORE_SEGMENT_BYTES);
+FlashQueue telemetryStore("/qt", STORE_TEL_SEGMENTS, STORE_SEGMENT_BYTES);
+uint8_t storeRecord[STORE_RECORD_MAX];
+uint8_t telemetryText[TELEMETRY_JSON_MAX];   // network task, too big for its stack next to TLS
+/* the telemetry document, same reason: a quarter of NETWORK_STACK while the publish may
+   run a TLS handshake; the network task's stack_free in the tasks diagnostics shows the margin */
+StaticJsonDocument<2048> telemetryDoc;       // ~100 slots once the aggregates are in
 
 /* =========================================================
    VARIABLES
    ========================================================= */
+/* owned by the sensing task */
 float ax_f = 0, ay_f = 0, az_f = 0;
 float gravityX = 0, gravityY = 0, gravityZ = 0;
 
-float lastNetAcc = 0;
+float netAccHist[SLOPE_LAG_MAX] = { 0 };
+uint8_t netAccIdx = 0;
+uint8_t slopeLag = SLOPE_SPAN / SENSOR_INTERVAL;   // samples spanning SLOPE_SPAN at the current rate
 unsigned long lastFallTime = 0;
 
-float tempThreshold = 36.0;
+/* the motion energy compares each sample with the one SLOPE_SPAN ms back, like
+   the slope, so its thresholds keep meaning what they meant at 50 Hz */
+struct MotionRef {
+  float ax, ay, az;
+  float gx, gy, gz;
+};
+MotionRef motionHist[SLOPE_LAG_MAX];               // same ring and index as netAccHist
+float motionEnergy = 0;
+float motionAlpha = 1 - expf(-(float)SENSOR_INTERVAL / MOTION_TAU_MS);   // follows the sample interval
+
+struct PostFallMonitor {
+  bool active;
+  unsigned long fallTime;      // impact that opened the window
+  unsigned long stillSince;    // start of the current still stretch (0 = not still)
+  unsigned long movingSince;   // start of the current moving stretch (0 = not moving)
+  uint8_t level;               // escalation level already sent
+  unsigned long lastAlert;     // time of the last follow-up alert
+};
+PostFallMonitor postFall = { false, 0, 0, 0, 0, 0 };
+
 bool tempAlertSent = false;
 
-unsigned long sensorMillis = 0;
-unsigned long publishMillis = 0;
-const unsigned long SENSOR_INTERVAL  = 20;
-const unsigned long PUBLISH_INTERVAL = 15000;
+envReadings_t env = { 0 };
+SensorScheduler scheduler;     // gets a PolledSensor per slow board that came up
+
+unsigned long setupDoneMs = 0;              // boot to the end of setup()
+volatile unsigned long firstSampleMs = 0;   // boot to the first sample taken, 0 = none yet
+
+/* written by the sensing task when it switches parameter sets, read by both */
+volatile float tempThreshold = 36.0;
+volatile uint32_t sensorIntervalMs = SENSOR_INTERVAL;
+
+uint32_t alertSeq = 0;                               // sensing task, last sequence number handed out
+volatile uint32_t bootCount = 0;                     // persisted as "boot", +1 per start
+
+/* alert delivery, network task only */
+struct AlertStats {
+  uint32_t sent;               // PUBACK received
+  uint32_t retries;            // resent with DUP after a reconnect
+  uint32_t failed;             // no PUBACK, the link was closed; resent once it is back
+  uint32_t dropped;            // could not be encoded, lost
+  uint32_t timed;              // deliveries with a known sample time
+  uint32_t latencyLastMs;      // sample -> PUBACK
+  uint32_t latencyMaxMs;
+  uint32_t latencySumMs;
+};
+AlertStats alertStats = { 0, 0, 0, 0, 0, 0, 0, 0 };
+
+/* telemetry delivery, network task only */
+struct TelemetryStats {
+  uint32_t sent;
+  uint32_t dropped;            // could not be encoded or never fits a publish, given up
+};
+TelemetryStats telemetryStats = { 0, 0 };
+
+/* per-task busy time, each counter written only by its own task */
+struct TaskStats {
+  TaskHandle_t handle;
+  volatile uint32_t busyUs;    // running total, wraps every ~71 min
+  uint32_t lastBusyUs;         // snapshot at the previous diagnostics report
+};
+TaskStats sensingStats = { NULL, 0, 0 };
+TaskStats networkStats = { NULL, 0, 0 };
+unsigned long diagMillis = 0;
+volatile uint32_t telemetryFormat = TELEMETRY_JSON;  // persisted as "tel_fmt"
+TelemetrySample lastTelemetry;                       // network task only, for the encode benchmark
+bool haveTelemetry = false;
+volatile uint32_t imuBatchEnabled = 1;               // persisted as "imu_batch"
+ImuBatchEncoder imuBatcher(SENSOR_INTERVAL);         // sensing task only
+imuBatch_t imuClosed;                                // sensing task, too big for its stack
+WindowStats window;                                  // sensing task, aggregates since the last publish
+
+/* live view: the network task starts, throttles and stops it, the sensing task feeds it */
+volatile uint32_t liveUntil = 0;                     // millis() deadline, 0 = off
+volatile uint8_t liveDecimate = 1;                   // every k-th sample
+ImuBatchEncoder liveBatcher(SENSOR_INTERVAL);        // sensing task only
+imuBatch_t liveClosed;
+uint8_t liveBatcherDecimate = 1;
+uint32_t liveTick = 0;
+struct LiveWatch {
+  bool announce;             // state change to publish
+  const char* reason;
+  unsigned long lastCheck;
+  unsigned long lastEnv;
+  uint32_t lastBusyUs;
+  uint32_t lastDropped;
+} liveWatch = { false, "", 0, 0, 0, 0 };
+PublishPolicy publishPolicy;                         // decided on the sensing task, configured from commands
+/* NVS keys of the deadbands, in PublishDeadband order */
+const char* const DEADBAND_KEYS[DB_COUNT] = { "db_temp", "db_tilt", "db_motion", "db_press", "db_hum", "db_co2", "db_light" };
+envReadings_t windowEnvSeen;                         // slow-board timestamps already counted
+bool benchRequested = false;
+bool profileDumpRequested = false;   // network task only, set from the command callback
+bool profileResetRequested = false;
+
+/* deadline accounting of the sensing loop, reported on TOPIC_DIAG */
+LoopTiming loopTiming(SENSOR_INTERVAL * 1000UL);
+
+/* runtime parameters; the network task stages, the sensing task switches between samples */
+detectionParams_t detectionDefaults() {
+  detectionParams_t p;
+  p.version = 0;
+  p.impactG = IMPACT_G;
+  p.impactSlopeG = IMPACT_SLOPE_G;
+  p.gyroSpike = GYRO_SPIKE;
+  p.fallCooldownMs = FALL_COOLDOWN;
+  p.alpha = ALPHA;
+  p.sensorIntervalMs = SENSOR_INTERVAL;
+  p.tempThreshold = tempThreshold;
+  p.publish.minMs = publishPolicy.cfg.minMs;
+  p.publish.activeMs = publishPolicy.cfg.activeMs;
+  p.publish.heartbeatMs = publishPolicy.cfg.heartbeatMs;
+  for (uint8_t i = 0; i < DB_COUNT; i++) p.publish.deadband[i] = publishPolicy.cfg.deadband[i];
+  return p;
+}
+DetectionConfig detection(detectionDefaults());
+detectionParams_t detectionSaved = detectionDefaults();   // network task, the NVS copy of the last staged set
+
+/* outcome of the last config command, answered on TOPIC_CONFIG_ACK once the set is in use */
+struct ConfigAck {
+  bool due;
+  uint32_t version;            // as requested
+  const char* status;          // applied, current, stale, rejected
+  const char* error;           // offending field when rejected
+};
+ConfigAck configAck = { false, 0, "", NULL };
+/* a valid set that found the spare buffer still taken, network task only */
+detectionParams_t configWaiting;
+bool configWaitingSet = false;
+
+/* connection state machine, network task only */
+enum LinkState : uint8_t {
+  LINK_WIFI_START,      // (re)issue WiFi.begin()
+  LINK_WIFI_WAIT,       // association / DHCP in progress
+  LINK_MQTT_CONNECT,    // Wi-Fi up, broker session needed
+  LINK_BACKOFF,         // waiting before the next attempt
+  LINK_UP
+};
+
+struct LinkManager {
+  LinkState state;
+  LinkState retryState;        // where to go when the backoff expires
+  unsigned long deadline;      // Wi-Fi wait timeout or backoff expiry
+  unsigned long downSince;     // start of the current outage
+  uint8_t failures;            // consecutive failed attempts
+  uint32_t reconnects;
+  unsigned long lastReconnectMs;
+  unsigned long maxReconnectMs;
+};
+LinkManager netLink = { LINK_WIFI_START, LINK_WIFI_START, 0, 0, 0, 0, 0, 0 };
+bool statusDue = false;        // retained online status owed after a connect
+
+/* modem sleep and upload bursts, network task only */
+RadioPower radio(RADIO_LISTEN_DTIMS, RADIO_AP_DTIM, RADIO_BURST_MS, RADIO_POLL_MS);
+unsigned long radioBusyAt = 0;  // last pass that had something to send
 
 /* =========================================================
    HELPERS
@@ -80,181 +442,1687 @@ float magnitude(float x, float y, float z) {
   return sqrt(x*x + y*y + z*z);
 }
 
+/* x rounded to a fixed number of decimals. Rounded as a double, so ArduinoJson
+   prints "0.12" instead of the nine decimals of the float nearest to it */
+double fixed(float x, uint8_t decimals) {
+  double scale = pow(10.0, decimals);
+  return round(x * scale) / scale;
+}
+
+/* the document as text in buf, 0 when its pool overflowed or the text does
+   not fit: serializeJson() cuts it off silently, leaving invalid JSON */
+size_t serializeChecked(const JsonDocument& doc, char* buf, size_t len) {
+  if (doc.overflowed() || measureJson(doc) >= len) return 0;
+  return serializeJson(doc, buf, len);
+}
+
 /* =========================================================
-   MQTT
+   MQTT (network task only)
    ========================================================= */
-void wifiConnect() {
-  WiFi.begin(ssid, password);
-  while (WiFi.status() != WL_CONNECTED) delay(300);
+void linkBackoff(unsigned long now, LinkState retry) {
+  unsigned long delayMs = BACKOFF_MAX;
+  if (netLink.failures < 16 && (BACKOFF_MIN << netLink.failures) < BACKOFF_MAX) {
+    delayMs = BACKOFF_MIN << netLink.failures;
+  }
+  if (netLink.failures < 255) netLink.failures++;
+  /* equal jitter: half fixed, half random, so a fleet does not retry in lockstep */
+  delayMs = delayMs / 2 + esp_random() % (delayMs / 2 + 1);
+
+  /* still associated (the broker failed, not Wi-Fi): keep the association,
+     in modem sleep; otherwise the radio is off until the next attempt */
+  if (WiFi.status() == WL_CONNECTED) radio.doze(now);
+  else radio.idle(now);
+  netLink.state = LINK_BACKOFF;
+  netLink.retryState = retry;
+  netLink.deadline = now + delayMs;
 }
 
-void mqttConnect() {
-  net.setInsecure();
-  client.begin(mqtt_server, mqtt_port, net);
-  while (!client.connect("esp32-baby", mqtt_user, mqtt_pass)) delay(500);
-  client.subscribe(TOPIC_COMMAND);
+void linkLost(unsigned long now, LinkState next) {
+  netLink.state = next;
+  netLink.downSince = now;
+  netLink.failures = 0;
+  Serial.println("📡 LINK LOST");
 }
 
-void publishMessage(const char* topic, const char* payload) {
-  if (!client.connected()) mqttConnect();
-  client.publish(topic, payload);
+/* One non-blocking step, except client.connect(): through TlsClient it blocks for the
+   broker's DNS lookup and TCP connect (WiFiClient's 3 s connect timeout), up to
+   TLS_HANDSHAKE_TIMEOUT_MS (10 s) of handshake, then up to MQTT_COMMAND_TIMEOUT (2 s)
+   for CONNACK. A connect attempt can therefore stall the network task for ~15 s plus
+   the DNS lookup; sensing goes on, alerts wait in their RAM queue meanwhile */
+void linkUpdate(unsigned long now) {
+  switch (netLink.state) {
+    case LINK_WIFI_START:
+      WiFi.disconnect();
+      radio.connect(ssid, password, now);
+      netLink.state = LINK_WIFI_WAIT;
+      netLink.deadline = now + WIFI_CONNECT_TIMEOUT;
+      break;
+
+    case LINK_WIFI_WAIT:
+      if (WiFi.status() == WL_CONNECTED) {
+        netLink.state = LINK_MQTT_CONNECT;
+      } else if ((long)(now - netLink.deadline) >= 0) {
+        linkBackoff(now, LINK_WIFI_START);
+      }
+      break;
+
+    case LINK_MQTT_CONNECT:
+      if (WiFi.status() != WL_CONNECTED) {
+        netLink.state = LINK_WIFI_START;
+        break;
+      }
+      radio.wake(now);                 // TLS and CONNACK without waiting for beacons
+      if (client.connect("esp32-baby", mqtt_user, mqtt_pass)) {
+        client.subscribe(TOPIC_COMMAND);
+        statusDue = true;
+        unsigned long took = millis() - netLink.downSince;
+        netLink.lastReconnectMs = took;
+        if (took > netLink.maxReconnectMs) netLink.maxReconnectMs = took;
+        netLink.reconnects++;
+        netLink.failures = 0;
+        netLink.state = LINK_UP;
+        Serial.print("📡 LINK UP after ");
+        Serial.print(took);
+        Serial.print(" ms, TLS ");
+        Serial.print(net.stats().lastResumed ? "resumed " : "full ");
+        Serial.print(net.stats().lastMs);
+        Serial.println(" ms");
+      } else {
+        linkBackoff(millis(), LINK_MQTT_CONNECT);
+      }
+      break;
+
+    case LINK_BACKOFF:
+      if ((long)(now - netLink.deadline) >= 0) netLink.state = netLink.retryState;
+      break;
+
+    case LINK_UP:
+      if (WiFi.status() != WL_CONNECTED) linkLost(now, LINK_WIFI_START);
+      else if (!client.connected()) linkLost(now, LINK_MQTT_CONNECT);
+      break;
+  }
 }
 
-void messageReceived(String& topic, String& payload) {
-  StaticJsonDocument<128> doc;
-  if (deserializeJson(doc, payload) == DeserializationError::Ok) {
-    if (doc.containsKey("temp_threshold")) {
-      tempThreshold = doc["temp_threshold"];
-      prefs.putFloat("temp_th", tempThreshold);
+bool linkUp() {
+  return netLink.state == LINK_UP;
+}
+
+/* outcome of a publish that may be tried again */
+enum SendResult : uint8_t {
+  SEND_OK,
+  SEND_RETRY,       // link down, or lost during the publish: same payload later
+  SEND_REJECTED     // the payload itself is bad, trying again cannot help
+};
+
+/* whether topic and payload fit the client buffer: fixed header, topic, packet id.
+   arduino-mqtt closes the connection on a publish that does not, so it must not be tried */
+bool mqttFits(const char* topic, size_t len) {
+  return 5 + 2 + strlen(topic) + 2 + len <= (size_t)MQTT_BUFFER;
+}
+
+bool publishMessage(const char* topic, const char* payload) {
+  if (!linkUp()) return false;
+  PROFILE_SCOPE(PROF_PUBLISH);
+  return client.publish(topic, payload);
+}
+
+bool publishMessage(const char* topic, const uint8_t* payload, size_t len) {
+  if (!linkUp()) return false;
+  PROFILE_SCOPE(PROF_PUBLISH);
+  return client.publish(topic, (const char*)payload, (int)len);
+}
+
+/* per topic sequence numbers (network task); alerts number themselves
+   (AlertEvent::seq), IMU and live batches carry theirs in the header.
+   Telemetry stamped for flash counts apart from the live stream: it is
+   numbered when stored and may be replayed long after, so sharing the live
+   numbers would make every outage look like a gap */
+enum MsgTopic : uint8_t {
+  MSG_SENSOR,
+  MSG_SENSOR_STORED,
+  MSG_DIAG,
+  MSG_STATUS,
+  MSG_LIVE,
+  MSG_CONFIG,
+  MSG_TOPICS
+};
+uint32_t topicSeq[MSG_TOPICS] = { 0 };
+
+/* sample to publish, network task only; reported and reset with the diagnostics */
+DelayHistogram telemetryDelay = {};
+DelayHistogram imuDelay = {};
+DelayHistogram alertAckDelay = {};   // sample to PUBACK
+
+MessageStamp stampMessage(MsgTopic topic, unsigned long sampleTime, bool stored = false) {
+  MessageStamp st;
+  st.seq = ++topicSeq[topic];
+  st.wallMs = wallClockMs(sampleTime);
+  st.queuedMs = millis() - sampleTime;
+  st.stored = stored;
+  return st;
+}
+
+/* a publish that failed hands its number back, so a retry does not look like a loss */
+void unstampMessage(MsgTopic topic) {
+  topicSeq[topic]--;
+}
+
+/* seq, device time t, wall time ts (once SNTP synced) and queueing delay qd;
+   for a stored message qd ends when it went to flash */
+void addStamp(JsonDocument& doc, const MessageStamp& st, unsigned long sampleTime) {
+  doc["seq"] = st.seq;
+  doc["t"] = sampleTime;
+  if (st.wallMs) doc["ts"] = st.wallMs;
+  doc["qd"] = st.queuedMs;
+  if (st.stored) doc["stored"] = true;
+}
+
+/* diagnostics and live view messages describe the moment they are built */
+bool publishDoc(const char* topic, MsgTopic id, JsonDocument& doc) {
+  unsigned long now = millis();
+  addStamp(doc, stampMessage(id, now), now);
+  char buf[1024];
+  size_t n = serializeChecked(doc, buf, sizeof(buf));
+  if (n && publishMessage(topic, (const uint8_t*)buf, n)) return true;
+  unstampMessage(id);
+  return false;
+}
+
+/* the alert whose PUBACK never came: arduino-mqtt closes the connection on
+   any failed publish, so it stays queued and goes out again after the
+   reconnect, with DUP set and the packet id of the lost attempt */
+struct Unacked {
+  char key[40];                // alertKey() of the alert, "" = none
+  uint16_t packetId;
+};
+Unacked unacked = { "", 0 };
+
+/* QoS 1, one attempt. arduino-mqtt waits for the PUBACK inside publish(), so
+   at most one message is in flight and the wait is bounded by
+   MQTT_COMMAND_TIMEOUT. key identifies an alert across resends, NULL for
+   messages that are not resent */
+bool publishReliable(const char* topic, const char* payload, size_t len, const char* key) {
+  if (!linkUp()) return false;
+  PROFILE_SCOPE(PROF_PUBLISH);
+  bool resend = key && strcmp(key, unacked.key) == 0;
+  if (resend) {
+    client.prepareDuplicate(unacked.packetId);
+    alertStats.retries++;
+  }
+  if (client.publish(topic, payload, (int)len, false, 1)) {
+    if (resend) unacked.key[0] = '\0';
+    return true;
+  }
+  alertStats.failed++;
+  if (key) {
+    snprintf(unacked.key, sizeof(unacked.key), "%s", key);
+    unacked.packetId = client.lastPacketID();
+  }
+  return false;
+}
+
+/* device, boot and sequence: unique per alert, the same for every retry and replay */
+void alertKey(char* buf, size_t len, uint32_t boot, uint32_t seq) {
+  snprintf(buf, len, "%s-%lu-%lu", DEVICE_ID, (unsigned long)boot, (unsigned long)seq);
+}
+
+/* PUBACK in hand: account for it and report the sample -> PUBACK latency */
+void alertDelivered(const char* key, bool timed, unsigned long sampleTime) {
+  alertStats.sent++;
+  StaticJsonDocument<256> ack;
+  ack["type"] = "alert_ack";
+  ack["id"] = key;
+  if (timed) {
+    uint32_t latency = millis() - sampleTime;
+    alertStats.timed++;
+    alertStats.latencyLastMs = latency;
+    alertStats.latencySumMs += latency;
+    if (latency > alertStats.latencyMaxMs) alertStats.latencyMaxMs = latency;
+    alertAckDelay.add(latency);
+    ack["latency_ms"] = latency;
+  }
+  publishDoc(TOPIC_DIAG, MSG_DIAG, ack);
+}
+
+size_t encodeAlert(const AlertEvent& ev, char* buf, size_t len, bool stored = false) {
+  PROFILE_SCOPE(PROF_JSON_ENCODE);
+  StaticJsonDocument<ALERT_DOC_SIZE> alert;
+  switch (ev.kind) {
+    case ALERT_FALL_IMPACT:
+      alert["alert"] = "fall_impact";
+      alert["status"] = true;
+      alert["severity_score"] = fixed(ev.value, 1);
+      break;
+    case ALERT_HIGH_TEMPERATURE:
+      alert["alert"] = "high_temperature";
+      alert["status"] = true;
+      alert["temperature"] = fixed(ev.value, 2);
+      break;
+    case ALERT_POST_FALL_INACTIVITY:
+      alert["alert"] = "post_fall_inactivity";
+      alert["status"] = true;
+      alert["level"] = ev.level;
+      alert["still_ms"] = ev.stillMs;
+      alert["since_fall_ms"] = ev.sinceFallMs;
+      alert["energy"] = fixed(ev.value, 1);
+      if (ev.final) alert["final"] = true;
+      break;
+    case ALERT_FALL_RECOVERY:
+      alert["alert"] = "fall_recovery";
+      alert["status"] = false;
+      alert["level"] = ev.level;
+      alert["recovery_ms"] = ev.sinceFallMs;
+      break;
+  }
+
+  /* held back while the link was down */
+  unsigned long age = millis() - ev.time;
+  if (age >= 1000) alert["held_ms"] = age;
+  /* went through flash, may reach the broker long after held_ms */
+  if (stored) alert["stored"] = true;
+
+  char key[40];
+  alertKey(key, sizeof(key), bootCount, ev.seq);
+  alert["id"] = key;
+  alert["seq"] = ev.seq;
+  alert["boot"] = bootCount;
+  alert["t"] = ev.time;
+  uint64_t wall = wallClockMs(ev.time);
+  if (wall) alert["ts"] = wall;
+  alert["qd"] = age;
+
+  return serializeChecked(alert, buf, len);
+}
+
+bool publishAlert(const AlertEvent& ev) {
+  char key[40];
+  alertKey(key, sizeof(key), bootCount, ev.seq);
+  char buf[ALERT_JSON_MAX];
+  size_t n = encodeAlert(ev, buf, sizeof(buf));
+  if (n == 0) {
+    alertStats.dropped++;      // nothing to send; keeping it would hold up every alert behind it
+    return true;
+  }
+  if (!publishReliable(TOPIC_ALERT, buf, n, key)) return false;
+  alertDelivered(key, true, ev.time);
+
+  switch (ev.kind) {
+    case ALERT_FALL_IMPACT:          Serial.println("🚨 BABY FALL ALERT SENT"); break;
+    case ALERT_HIGH_TEMPERATURE:     Serial.println("🌡 TEMPERATURE ALERT SENT"); break;
+    case ALERT_POST_FALL_INACTIVITY: Serial.print("⚠ POST-FALL INACTIVITY LEVEL "); Serial.println(ev.level); break;
+    case ALERT_FALL_RECOVERY:        Serial.println("✅ MOVEMENT RESUMED AFTER FALL"); break;
+  }
+  return true;
+}
+
+size_t encodeTelemetry(const TelemetrySample& s, const MessageStamp& stamp, char* buf, size_t len) {
+  PROFILE_SCOPE(PROF_JSON_ENCODE);
+  JsonDocument& data = telemetryDoc;
+  data.clear();
+
+  /* fixed decimals: full precision doubles would take 1.5 KB and say nothing more */
+  /* environment only samples (no IMU fitted) leave the motion objects out */
+  if (s.imu) {
+    JsonObject acc = data.createNestedObject("acc");
+    acc["x"] = fixed(s.ax, 1);
+    acc["y"] = fixed(s.ay, 1);
+    acc["z"] = fixed(s.az, 1);
+    acc["net"] = fixed(s.netAcc, 1);
+
+    JsonObject gyro = data.createNestedObject("gyro");
+    gyro["x"] = fixed(s.gx, 1);
+    gyro["y"] = fixed(s.gy, 1);
+    gyro["z"] = fixed(s.gz, 1);
+    gyro["mag"] = fixed(s.gyroMag, 1);
+
+    JsonObject tilt = data.createNestedObject("tilt");
+    tilt["x"] = fixed(s.tx, 2);
+    tilt["y"] = fixed(s.ty, 2);
+    tilt["z"] = fixed(s.tz, 2);
+  }
+
+  if (!isnan(s.tempC)) data["temp"] = fixed(s.tempC, 2);
+  data["thresTemp"] = fixed(s.thresTemp, 2);
+  data["reason"] = PublishPolicy::reasonName((PublishReason)s.reason);
+  addStamp(data, stamp, s.time);
+
+  /* slow boards, only those that have produced a reading */
+  JsonObject envObj = data.createNestedObject("env");
+  if (s.env.baroTime) {
+    envObj["pressure"] = fixed(s.env.pressureHpa, 2);
+    envObj["baro_temp"] = fixed(s.env.baroTempC, 2);
+  }
+  if (s.env.humTime) {
+    envObj["humidity"] = fixed(s.env.humidity, 1);
+    envObj["hum_temp"] = fixed(s.env.humTempC, 2);
+  }
+  if (s.env.airTime) {
+    envObj["co2"] = s.env.co2;
+    envObj["tvoc"] = s.env.tvoc;
+  }
+  if (s.env.lightTime) {
+    envObj["light"] = s.env.ambientLight;
+    envObj["proximity"] = s.env.proximity;
+  }
+
+  /* window aggregates: [n, min, max, mean, std, over], channels with no samples left out */
+  JsonObject agg = data.createNestedObject("agg");
+  agg["window_ms"] = s.time - s.agg.startMs;
+  for (uint8_t i = 0; i < AGG_CHANNELS; i++) {
+    const RunningStats& st = s.agg.ch[i];
+    if (st.count == 0) continue;
+    uint8_t d = AGG_CHANNEL_DECIMALS[i];
+    JsonArray a = agg.createNestedArray(AGG_CHANNEL_NAMES[i]);
+    a.add(st.count);
+    a.add(fixed(st.min, d));
+    a.add(fixed(st.max, d));
+    a.add(fixed(st.mean, d));
+    a.add(fixed(st.stddev(), d));
+    a.add(st.over);
+  }
+
+  return serializeChecked(data, buf, len);
+}
+
+/* payload in the configured format, JSON when the binary frame cannot hold it */
+/* binary frames and JSON go to their own topics, subscribers of TOPIC_SENSOR only ever get JSON */
+const char* telemetryTopic(const uint8_t* data, size_t len) {
+  bool binary = len >= 2 && data[0] == TELEMETRY_BIN_MAGIC0 && data[1] == TELEMETRY_BIN_MAGIC1;
+  return binary ? TOPIC_SENSOR_BIN : TOPIC_SENSOR;
+}
+
+size_t encodeTelemetryPayload(const TelemetrySample& s, const MessageStamp& stamp, uint8_t* buf, size_t len) {
+  if (telemetryFormat == TELEMETRY_BINARY) {
+    PROFILE_SCOPE(PROF_JSON_ENCODE);
+    size_t n = encodeTelemetryBinary(s, stamp, buf, len);
+    if (n) return n;
+  }
+  return encodeTelemetry(s, stamp, (char*)buf, len);
+}
+
+/* a sample that cannot be encoded or sent keeps its sequence number, so it shows as a gap */
+SendResult publishTelemetry(const TelemetrySample& s) {
+  lastTelemetry = s;
+  haveTelemetry = true;
+  if (!linkUp()) return SEND_RETRY;
+  uint8_t* buf = telemetryText;
+  MessageStamp stamp = stampMessage(MSG_SENSOR, s.time);
+  size_t n = encodeTelemetryPayload(s, stamp, buf, TELEMETRY_JSON_MAX);
+  const char* topic = telemetryTopic(buf, n);
+  if (n == 0 || !mqttFits(topic, n)) {
+    telemetryStats.dropped++;
+    return SEND_REJECTED;
+  }
+  if (publishMessage(topic, buf, n)) {
+    telemetryStats.sent++;
+    telemetryDelay.add(stamp.queuedMs);
+    return SEND_OK;
+  }
+  unstampMessage(MSG_SENSOR);
+  return SEND_RETRY;
+}
+
+/* =========================================================
+   STORE-AND-FORWARD (network task)
+   ========================================================= */
+/* move whatever the RAM queues hold to flash, already encoded. An alert the
+   flash refuses stays in RAM and is still published from there */
+void storeAlerts() {
+  AlertEvent ev;
+  while (alertQueue.peek(ev)) {
+    size_t n = encodeAlert(ev, (char*)storeRecord, sizeof(storeRecord), true);
+    if (n == 0) {
+      alertStats.dropped++;      // no payload to keep, in flash or in RAM
+    } else if (!alertStore.push(storeRecord, n)) {
+      break;
     }
+    alertQueue.pop(ev);
+  }
+}
+
+void storeTelemetry() {
+  TelemetrySample s;
+  while (telemetryQueue.pop(s)) {
+    size_t n = encodeTelemetryPayload(s, stampMessage(MSG_SENSOR_STORED, s.time, true), storeRecord, sizeof(storeRecord));
+    if (n) telemetryStore.push(storeRecord, n);
+    else telemetryStats.dropped++;
   }
 }
 
+/* anything still waiting on an alert holds back everything else */
+bool alertPending() {
+  return alertQueue.size() != 0 || !alertStore.empty();
+}
+
+/* FlashQueue::drain() callbacks */
+bool publishStoredAlert(const uint8_t* data, uint16_t len, void* ctx) {
+  StaticJsonDocument<ALERT_DOC_SIZE> alert;
+  DeserializationError err = deserializeJson(alert, (const char*)data, len);
+  bool parsed = err == DeserializationError::Ok;
+  if (!parsed) {
+    Serial.print("⚠ stored alert unreadable: ");
+    Serial.println(err.c_str());
+  }
+  const char* key = parsed ? (alert["id"] | "") : "";
+  if (!publishReliable(TOPIC_ALERT, (const char*)data, len, key[0] ? key : NULL)) return false;
+  /* the sample time only means something within the boot that stored it */
+  if (parsed) {
+    alertDelivered(key, (alert["boot"] | 0UL) == bootCount, alert["t"] | 0UL);
+  } else {
+    alertDelivered("", false, 0);
+  }
+  return true;
+}
+
+/* a record that can never be sent is consumed and counted, it would hold up the rest */
+bool publishStoredTelemetry(const uint8_t* data, uint16_t len, void* ctx) {
+  if (alertQueue.size() != 0) return false;
+  const char* topic = telemetryTopic(data, len);
+  if (!mqttFits(topic, len)) {
+    telemetryStats.dropped++;
+    return true;
+  }
+  if (!publishMessage(topic, data, len)) return false;
+  telemetryStats.sent++;
+  return true;
+}
+
+/* encode the last published sample both ways, answers {"cmd":"telemetry_bench"} */
+void publishTelemetryBench() {
+  if (!haveTelemetry) return;
+  const uint16_t ITERATIONS = 100;
+  char* text = (char*)telemetryText;
+  uint8_t frame[TELEMETRY_BIN_MAX];
+  size_t jsonBytes = 0, binBytes = 0;
+  MessageStamp stamp = { 0, wallClockMs(lastTelemetry.time), 0, false };
+
+  uint32_t t0 = (uint32_t)esp_timer_get_time();
+  for (uint16_t i = 0; i < ITERATIONS; i++) jsonBytes = encodeTelemetry(lastTelemetry, stamp, text, TELEMETRY_JSON_MAX);
+  uint32_t t1 = (uint32_t)esp_timer_get_time();
+  for (uint16_t i = 0; i < ITERATIONS; i++) binBytes = encodeTelemetryBinary(lastTelemetry, stamp, frame, sizeof(frame));
+  uint32_t t2 = (uint32_t)esp_timer_get_time();
+
+  StaticJsonDocument<256> diag;
+  diag["type"] = "telemetry_bench";
+  diag["iterations"] = ITERATIONS;
+  diag["json_us"] = (float)(t1 - t0) / ITERATIONS;
+  diag["json_bytes"] = jsonBytes;
+  diag["binary_us"] = (float)(t2 - t1) / ITERATIONS;
+  diag["binary_bytes"] = binBytes;
+
+  publishDoc(TOPIC_DIAG, MSG_DIAG, diag);
+}
+
 /* =========================================================
-   SETUP
+   DIAGNOSTICS
    ========================================================= */
-void setup() {
-  Serial.begin(115200);
-  Wire.begin();
+template <typename T, size_t N>
+void queueDiag(JsonObject obj, const SpscQueue<T, N>& q) {
+  obj["depth"] = q.size();
+  obj["hwm"] = q.highWater();
+  obj["cap"] = q.capacity();
+  obj["dropped"] = q.dropped();
+}
 
-  prefs.begin("config", false);
-  tempThreshold = prefs.getFloat("temp_th", tempThreshold);
-  tempAlertSent = false;  // FORCE RESET
+void storeDiag(JsonObject obj, const FlashQueue& q) {
+  obj["segments"] = q.segments();
+  obj["appended"] = q.appended();
+  obj["drained"] = q.drained();
+  obj["dropped"] = q.dropped();
+  obj["dropped_segments"] = q.droppedSegments();
+  obj["corrupt"] = q.corrupt();
+}
 
-  wifiConnect();
-  client.onMessage(messageReceived);
-  mqttConnect();
+void taskDiag(JsonObject obj, TaskStats& stats, unsigned long windowMs) {
+  uint32_t busy = stats.busyUs;
+  obj["load"] = windowMs ? (busy - stats.lastBusyUs) / (10.0f * windowMs) : 0.0f;  // percent of one core
+  obj["stack_free"] = uxTaskGetStackHighWaterMark(stats.handle);
+  stats.lastBusyUs = busy;
+}
 
-  while (!Ag.begin()) delay(200);
-  while (!Pr.begin()) delay(200);
+void delayDiag(JsonObject obj, DelayHistogram& h) {
+  obj["n"] = h.count;
+  obj["max"] = h.maxMs;
+  JsonArray hist = obj.createNestedArray("hist");
+  for (uint8_t i = 0; i < DELAY_BUCKETS; i++) hist.add(h.bucket[i]);
+  h.reset();
+}
 
-  /* Gravity calibration */
-  float sx=0, sy=0, sz=0;
-  for (int i=0;i<30;i++) {
-    sx += Ag.getAccelX();
-    sy += Ag.getAccelY();
-    sz += Ag.getAccelZ();
-    delay(20);
+/* queueing delay since the last report; bucket edges in DelayHistogram.h */
+void publishQueueDelay() {
+  StaticJsonDocument<1024> diag;
+  diag["type"] = "queue_delay";
+  delayDiag(diag.createNestedObject("telemetry"), telemetryDelay);
+  delayDiag(diag.createNestedObject("imu"), imuDelay);
+  delayDiag(diag.createNestedObject("alert_ack"), alertAckDelay);
+  publishDoc(TOPIC_DIAG, MSG_DIAG, diag);
+}
+
+/* delivery side: store-and-forward, alerts, link; its own message to stay inside the MQTT buffer */
+void publishNetDiagnostics(unsigned long now) {
+  StaticJsonDocument<1024> diag;
+  diag["type"] = "net";
+  diag["uptime_ms"] = now;
+
+  JsonObject store = diag.createNestedObject("store");
+  storeDiag(store.createNestedObject("alert"), alertStore);
+  storeDiag(store.createNestedObject("telemetry"), telemetryStore);
+
+  JsonObject alerts = diag.createNestedObject("alerts");
+  alerts["seq"] = alertSeq;
+  alerts["sent"] = alertStats.sent;
+  alerts["retries"] = alertStats.retries;
+  alerts["failed"] = alertStats.failed;
+  alerts["dropped"] = alertStats.dropped;
+  if (alertStats.timed) {
+    alerts["latency_last_ms"] = alertStats.latencyLastMs;
+    alerts["latency_max_ms"] = alertStats.latencyMaxMs;
+    alerts["latency_mean_ms"] = alertStats.latencySumMs / alertStats.timed;
+  }
+
+  JsonObject tel = diag.createNestedObject("telemetry");
+  tel["sent"] = telemetryStats.sent;
+  tel["dropped"] = telemetryStats.dropped;
+
+  diag["clock_synced"] = wallClockSynced();
+
+  JsonObject linkObj = diag.createNestedObject("link");
+  linkObj["reconnects"] = netLink.reconnects;
+  linkObj["last_ms"] = netLink.lastReconnectMs;
+  linkObj["max_ms"] = netLink.maxReconnectMs;
+  linkObj["rssi"] = WiFi.RSSI();
+
+  const tlsStats_t& tls = net.stats();
+  JsonObject tlsObj = linkObj.createNestedObject("tls");
+  tlsObj["handshakes"] = tls.handshakes;
+  tlsObj["resumed"] = tls.resumed;
+  tlsObj["failures"] = tls.failures;
+  tlsObj["last_ms"] = tls.lastMs;
+  tlsObj["last_tcp_ms"] = tls.lastTcpMs;
+  tlsObj["max_ms"] = tls.maxMs;
+  uint32_t full = tls.handshakes - tls.resumed;
+  if (full) tlsObj["full_mean_ms"] = tls.fullMsTotal / full;
+  if (tls.resumed) tlsObj["resumed_mean_ms"] = tls.resumedMsTotal / tls.resumed;
+  if (tls.lastError) tlsObj["last_error"] = tls.lastError;
+
+  publishDoc(TOPIC_DIAG, MSG_DIAG, diag);
+}
+
+void radioHourDiag(JsonObject obj, const radioHour_t& h) {
+  obj["on_ms"] = radio.onMs(h);         // estimate, modem sleep counted by its listen duty
+  obj["awake_ms"] = h.ms[RADIO_AWAKE];
+  obj["doze_ms"] = h.ms[RADIO_DOZE];
+  obj["connecting_ms"] = h.ms[RADIO_CONNECTING];
+  obj["off_ms"] = h.ms[RADIO_OFF];
+  obj["wakes"] = h.wakes;
+  obj["bursts"] = h.bursts;
+}
+
+/* bus traffic and faults per device since boot; bus_us over uptime is the bus load */
+void publishI2cDiagnostics(unsigned long now) {
+  I2cBus& bus = I2cBus::shared();
+  StaticJsonDocument<1536> diag;
+  diag["type"] = "i2c";
+  diag["uptime_ms"] = now;
+  diag["clock_hz"] = bus.clockHz();
+  diag["recoveries"] = bus.recoveries();
+  diag["stuck"] = bus.stuck();
+  JsonObject devs = diag.createNestedObject("devices");
+  for (int8_t d = 0; d < (int8_t)bus.devices(); d++) {
+    i2cDeviceStats_t st = bus.stats(d);
+    JsonObject o = devs.createNestedObject(st.name);
+    o["n"] = st.transactions;
+    o["fail"] = st.failures;
+    o["retries"] = st.retries;
+    o["timeouts"] = st.timeouts;
+    o["streak"] = st.failStreak;      // failed in a row right now
+    o["last"] = (uint8_t)st.lastResult;
+    o["tx"] = st.bytesWritten;
+    o["rx"] = st.bytesRead;
+    o["bus_us"] = st.busUs;
+    o["max_us"] = st.maxUs;
+    if (st.transactions) o["mean_us"] = st.busUs / st.transactions;
+  }
+  publishDoc(TOPIC_DIAG, MSG_DIAG, diag);
+}
+
+/* radio duty cycle: the hour so far and the last full hour */
+void publishRadioDiagnostics(unsigned long now) {
+  StaticJsonDocument<512> diag;
+  diag["type"] = "radio";
+  diag["listen_interval"] = radio.listenInterval();
+  diag["burst_ms"] = RADIO_BURST_MS;
+  diag["hour_elapsed_ms"] = radio.hourElapsedMs(now);
+  radioHourDiag(diag.createNestedObject("this_hour"), radio.thisHour());
+  radioHourDiag(diag.createNestedObject("last_hour"), radio.lastHour());
+  publishDoc(TOPIC_DIAG, MSG_DIAG, diag);
+}
+
+void publishDiagnostics(unsigned long now) {
+  unsigned long windowMs = now - diagMillis;
+  diagMillis = now;
+
+  StaticJsonDocument<768> diag;
+  diag["type"] = "tasks";
+  diag["uptime_ms"] = now;
+
+  JsonObject tasks = diag.createNestedObject("tasks");
+  taskDiag(tasks.createNestedObject("sensing"), sensingStats, windowMs);
+  taskDiag(tasks.createNestedObject("network"), networkStats, windowMs);
+
+  JsonObject queues = diag.createNestedObject("queues");
+  queueDiag(queues.createNestedObject("alert"), alertQueue);
+  queueDiag(queues.createNestedObject("telemetry"), telemetryQueue);
+
+  JsonObject sensors = diag.createNestedObject("sensors");
+  for (uint8_t i = 0; i < scheduler.count(); i++) {
+    PolledSensor* ps = scheduler.get(i);
+    JsonObject o = sensors.createNestedObject(ps->name());
+    o["ok"] = ps->readings();
+    o["err"] = ps->errors();
   }
-  gravityX = sx/30;
-  gravityY = sy/30;
-  gravityZ = sz/30;
 
-  Serial.println("✅ Baby fall & temperature system READY");
+  publishDoc(TOPIC_DIAG, MSG_DIAG, diag);
+
+  publishNetDiagnostics(now);
+  publishRadioDiagnostics(now);
+  publishI2cDiagnostics(now);
+  publishQueueDelay();
+}
+
+/* retained online status: replaces the last will on the broker, so a late
+   subscriber sees at once which devices are up and what they run */
+bool publishStatus(unsigned long now) {
+  if (!linkUp()) return false;
+  StaticJsonDocument<1024> st;
+  st["state"] = "online";
+  st["fw"] = FIRMWARE_VERSION;
+  st["boot"] = bootCount;
+  st["uptime_ms"] = now;
+  st["reconnects"] = netLink.reconnects;
+  st["setup_ms"] = setupDoneMs;
+  if (firstSampleMs) st["first_sample_ms"] = firstSampleMs;
+
+  /* what the boot scan found and how bring-up went; an absent optional
+     board is no fault, one that answered and failed is */
+  JsonObject bd = st.createNestedObject("boards");
+  for (uint8_t b = 0; b < BOARD_COUNT; b++) {
+    bd[boards.name((BoardId)b)] = BoardScan::stateName(boards.state((BoardId)b));
+  }
+
+  /* a sensor is healthy while it reads more often than it fails */
+  bool healthy = true;
+  JsonObject sensors = st.createNestedObject("sensors");
+  bool imuOk = Ag && !i2cFailed(Ag->busResult());
+  sensors["imu"] = imuOk;
+  if (!imuOk) healthy = false;
+  for (uint8_t i = 0; i < scheduler.count(); i++) {
+    PolledSensor* ps = scheduler.get(i);
+    bool ok = ps->errors() <= ps->readings();
+    sensors[ps->name()] = ok;
+    if (!ok) healthy = false;
+  }
+  for (uint8_t b = 0; b < BOARD_COUNT; b++) {
+    BoardState s = boards.state((BoardId)b);
+    if (s == BOARD_WRONG_ID || s == BOARD_INIT_FAILED) healthy = false;
+  }
+  st["health"] = healthy ? "ok" : "degraded";
+
+  MessageStamp stamp = stampMessage(MSG_STATUS, now);
+  addStamp(st, stamp, now);
+  char buf[768];
+  size_t n = serializeChecked(st, buf, sizeof(buf));
+  if (n == 0) return true;   // never sendable; the next diagnostics round builds a new one
+  PROFILE_SCOPE(PROF_PUBLISH);
+  if (client.publish(TOPIC_STATUS, buf, (int)n, true, 1)) return true;
+  unstampMessage(MSG_STATUS);
+  return false;
+}
+
+/* answer to the last config command, with the whole set now in use */
+bool publishConfigAck(unsigned long now) {
+  const detectionParams_t& p = detection.latest();   // in use: nothing is pending
+  StaticJsonDocument<768> ack;
+  ack["type"] = "config_ack";
+  ack["schema"] = DETECTION_SCHEMA;
+  ack["version"] = configAck.version;
+  ack["status"] = configAck.status;
+  if (configAck.error) ack["error"] = configAck.error;
+
+  JsonObject a = ack.createNestedObject("active");
+  a["version"] = p.version;
+  a["impact_g"] = p.impactG;
+  a["impact_slope_g"] = p.impactSlopeG;
+  a["gyro_spike"] = p.gyroSpike;
+  a["fall_cooldown_ms"] = p.fallCooldownMs;
+  a["alpha"] = p.alpha;
+  a["sensor_interval_ms"] = p.sensorIntervalMs;
+  a["temp_threshold"] = p.tempThreshold;
+  JsonObject pub = a.createNestedObject("publish");
+  pub["min_ms"] = p.publish.minMs;
+  pub["active_ms"] = p.publish.activeMs;
+  pub["heartbeat_ms"] = p.publish.heartbeatMs;
+  JsonObject db = pub.createNestedObject("deadband");
+  for (uint8_t i = 0; i < DB_COUNT; i++) db[PUBLISH_DEADBAND_NAMES[i]] = p.publish.deadband[i];
+
+  MessageStamp stamp = stampMessage(MSG_CONFIG, now);
+  addStamp(ack, stamp, now);
+  char buf[768];
+  size_t n = serializeChecked(ack, buf, sizeof(buf));
+  if (n == 0) return true;   // never sendable, retrying cannot help
+  if (publishReliable(TOPIC_CONFIG_ACK, buf, n, NULL)) return true;
+  unstampMessage(MSG_CONFIG);
+  return false;
+}
+
+void publishTiming(const timingReport_t& r) {
+  StaticJsonDocument<1024> diag;
+  diag["type"] = "timing";
+  diag["period_us"] = sensorIntervalMs * 1000UL;
+  diag["window_ms"] = r.windowUs / 1000;
+  diag["ticks"] = r.ticks;
+  diag["late"] = r.late;
+  diag["overrun"] = r.overrun;
+
+  JsonObject interval = diag.createNestedObject("interval_us");
+  interval["min"] = r.intervals ? r.intervalMinUs : 0;
+  interval["avg"] = r.intervals ? r.intervalSumUs / r.intervals : 0;
+  interval["max"] = r.intervalMaxUs;
+
+  JsonObject busy = diag.createNestedObject("busy_us");
+  busy["min"] = r.ticks ? r.busyMinUs : 0;
+  busy["avg"] = r.ticks ? r.busySumUs / r.ticks : 0;
+  busy["max"] = r.busyMaxUs;
+
+  /* bucket edges: TIMING_JITTER_EDGES_US / TIMING_BUSY_EDGES_US */
+  JsonArray jitter = diag.createNestedArray("jitter_hist");
+  JsonArray work = diag.createNestedArray("busy_hist");
+  for (uint8_t i = 0; i < TIMING_BUCKETS; i++) {
+    jitter.add(r.jitterHist[i]);
+    work.add(r.busyHist[i]);
+  }
+
+  publishDoc(TOPIC_DIAG, MSG_DIAG, diag);
+}
+
+/* one message per stage keeps each well inside the MQTT buffer */
+void publishProfile() {
+#if MYOSA_PROFILE
+  profileSummary_t p;
+  for (uint8_t i = 0; i < PROF_STAGES; i++) {
+    if (!profileSummary(i, &p)) continue;
+    StaticJsonDocument<320> diag;
+    diag["type"] = "profile";
+    diag["stage"] = profileStageName(i);
+    diag["cpu_mhz"] = ESP.getCpuFreqMHz();
+    diag["n"] = p.count;
+    diag["min"] = p.minCycles;
+    diag["mean"] = p.meanCycles;
+    diag["max"] = p.maxCycles;
+    diag["p99"] = p.p99Cycles;
+
+    publishDoc(TOPIC_DIAG, MSG_DIAG, diag);
+  }
+#else
+  StaticJsonDocument<128> diag;
+  diag["type"] = "profile";
+  diag["enabled"] = false;
+  publishDoc(TOPIC_DIAG, MSG_DIAG, diag);
+#endif
 }
 
 /* =========================================================
-   LOOP
+   POST-FALL MONITOR (sensing task)
    ========================================================= */
-void loop() {
-  client.loop();
-  unsigned long now = millis();
-  if (now - sensorMillis < SENSOR_INTERVAL) return;
-  sensorMillis = now;
-
-  /* -------- RAW SENSOR -------- */
-  float ax = Ag.getAccelX();
-  float ay = Ag.getAccelY();
-  float az = Ag.getAccelZ();
-
-  float gx = Ag.getGyroX();
-  float gy = Ag.getGyroY();
-  float gz = Ag.getGyroZ();
-
-  float tx = Ag.getTiltX();
-  float ty = Ag.getTiltY();
-  float tz = Ag.getTiltZ();
-  
-  float tempC = Ag.getTempC();
-
-  /* -------- FILTER -------- */
-  ax_f = ALPHA * ax + (1 - ALPHA) * ax_f;
-  ay_f = ALPHA * ay + (1 - ALPHA) * ay_f;
-  az_f = ALPHA * az + (1 - ALPHA) * az_f;
-
-  /* -------- MAGNITUDES -------- */
-  float netAcc = magnitude(
-    ax - gravityX,
-    ay - gravityY,
-    az - gravityZ
-  );
-
-  float gyroMag = magnitude(gx, gy, gz);
-  float accSlope = netAcc - lastNetAcc;
-  lastNetAcc = netAcc;
+/* numbered even when the queue is full, so a lost alert shows up as a gap */
+void queueAlert(AlertEvent& ev) {
+  ev.seq = ++alertSeq;
+  alertQueue.push(ev);
+  if (networkStats.handle) xTaskNotifyGive(networkStats.handle);  // don't wait out NETWORK_POLL
+}
+
+void raiseAlert(AlertKind kind, unsigned long now, float value) {
+  AlertEvent ev = { kind, 0, false, now, value, 0, 0 };
+  queueAlert(ev);
+}
+
+void postFallStart(unsigned long now) {
+  postFall.active = true;
+  postFall.fallTime = now;
+  postFall.stillSince = 0;
+  postFall.movingSince = 0;
+  postFall.level = 0;
+  postFall.lastAlert = lastFallAlertTime;
+}
+
+void postFallAlert(unsigned long now, bool final) {
+  AlertEvent ev = {
+    ALERT_POST_FALL_INACTIVITY, postFall.level, final, now, motionEnergy,
+    now - postFall.stillSince, now - postFall.fallTime
+  };
+  queueAlert(ev);
+  postFall.lastAlert = now;
+}
+
+void postFallRecovery(unsigned long now) {
+  AlertEvent ev = {
+    ALERT_FALL_RECOVERY, postFall.level, false, now, motionEnergy,
+    0, now - postFall.fallTime
+  };
+  queueAlert(ev);
+  postFall.active = false;
+}
+
+/* Evaluated once per sample, never blocks */
+void postFallUpdate(unsigned long now) {
+  if (!postFall.active) return;
+
+  if (motionEnergy < STILL_ENERGY) {
+    postFall.movingSince = 0;
+    if (postFall.stillSince == 0) postFall.stillSince = now;
+  } else if (motionEnergy > MOVE_ENERGY) {
+    postFall.stillSince = 0;
+    if (postFall.movingSince == 0) postFall.movingSince = now;
+    if (now - postFall.movingSince >= RECOVERY_HOLD) {
+      postFallRecovery(now);
+      return;
+    }
+  }
+
+  if (postFall.stillSince != 0) {
+    unsigned long still = now - postFall.stillSince;
+    if (postFall.level < INACTIVITY_LEVELS && still >= INACTIVITY_STAGES[postFall.level]) {
+      postFall.level++;
+      postFallAlert(now, false);
+    } else if (postFall.level == INACTIVITY_LEVELS && now - postFall.lastAlert >= ALERT_COOLDOWN) {
+      postFallAlert(now, false);
+    }
+  }
+
+  if (now - postFall.fallTime >= POST_FALL_WINDOW) {
+    /* window over with no recovery seen: leave a last word if still lying there */
+    if (postFall.stillSince != 0 && postFall.level > 0) postFallAlert(now, true);
+    postFall.active = false;
+  }
+}
+
+/* =========================================================
+   LIVE VIEW (network task)
+   ========================================================= */
+void liveStop(const char* reason) {
+  if (liveUntil == 0) return;
+  liveUntil = 0;
+  liveWatch.announce = true;
+  liveWatch.reason = reason;
+}
+
+void liveStart(uint32_t seconds, uint8_t decimate) {
+  if (seconds == 0) {
+    liveStop("command");
+    return;
+  }
+  if (seconds > LIVE_MAX_SECONDS) seconds = LIVE_MAX_SECONDS;
+  if (decimate < 1) decimate = 1;
+  if (decimate > LIVE_MAX_DECIMATE) decimate = LIVE_MAX_DECIMATE;
+  liveDecimate = decimate;
+  liveUntil = (millis() + seconds * 1000UL) | 1;  // never 0 = off
+  liveWatch.announce = true;
+  liveWatch.reason = "command";
+  liveWatch.lastCheck = millis();
+  liveWatch.lastBusyUs = sensingStats.busyUs;
+  liveWatch.lastDropped = liveQueue.dropped();
+}
+
+void publishLiveState(unsigned long now) {
+  StaticJsonDocument<192> st;
+  st["type"] = "live";
+  st["state"] = liveUntil ? "on" : "off";
+  st["reason"] = liveWatch.reason;
+  if (liveUntil) {
+    st["remaining_ms"] = (long)(liveUntil - now);
+    st["period_ms"] = sensorIntervalMs * liveDecimate;
+  }
+  publishDoc(TOPIC_LIVE, MSG_LIVE, st);
+}
+
+/* slow boards for the live view; fields are read while the sensing task may
+   be updating them, a snapshot can mix readings one tick apart */
+void publishLiveEnv(unsigned long now) {
+  StaticJsonDocument<320> e;
+  e["type"] = "env";
+  e["t"] = now;
+  if (haveTelemetry) e["temp"] = lastTelemetry.tempC;
+  if (env.baroTime) e["pressure"] = env.pressureHpa;
+  if (env.humTime) e["humidity"] = env.humidity;
+  if (env.airTime) {
+    e["co2"] = env.co2;
+    e["tvoc"] = env.tvoc;
+  }
+  if (env.lightTime) {
+    e["light"] = env.ambientLight;
+    e["proximity"] = env.proximity;
+  }
+  publishDoc(TOPIC_LIVE, MSG_LIVE, e);
+}
+
+/* expiry, and fall detection first: halve the rate when the sensing core or
+   the live queue runs short, give up once already at the lowest rate */
+void liveUpdate(unsigned long now) {
+  uint32_t until = liveUntil;
+  if (until != 0 && (long)(until - now) <= 0) liveStop("expired");
+
+  if (liveUntil != 0 && now - liveWatch.lastCheck >= LIVE_CHECK_MS) {
+    uint32_t busy = sensingStats.busyUs;
+    float load = (busy - liveWatch.lastBusyUs) / (10.0f * (now - liveWatch.lastCheck));
+    uint32_t dropped = liveQueue.dropped();
+    bool tight = load > LIVE_MAX_SENSING_LOAD || dropped != liveWatch.lastDropped ||
+                  liveQueue.size() > liveQueue.capacity() / 2 || alertQueue.size() > 0;
+    liveWatch.lastCheck = now;
+    liveWatch.lastBusyUs = busy;
+    liveWatch.lastDropped = dropped;
+    if (tight) {
+      if (liveDecimate < LIVE_MAX_DECIMATE) {
+        liveDecimate = liveDecimate * 2 > LIVE_MAX_DECIMATE ? LIVE_MAX_DECIMATE : liveDecimate * 2;
+        liveWatch.announce = true;
+        liveWatch.reason = "headroom";
+      } else {
+        liveStop("headroom");
+      }
+    }
+  }
+
+  if (liveUntil != 0 && now - liveWatch.lastEnv >= LIVE_ENV_INTERVAL) {
+    liveWatch.lastEnv = now;
+    publishLiveEnv(now);
+  }
+  if (liveWatch.announce) {
+    liveWatch.announce = false;
+    publishLiveState(now);
+  }
+}
+
+/* {"min_ms":..,"active_ms":..,"heartbeat_ms":..,"deadband":{"temp":..,"tilt":..}} over p */
+void mergePublishParams(JsonObject pub, publishParams_t& p) {
+  if (pub.containsKey("min_ms")) p.minMs = pub["min_ms"].as<uint32_t>();
+  if (pub.containsKey("active_ms")) p.activeMs = pub["active_ms"].as<uint32_t>();
+  if (pub.containsKey("heartbeat_ms")) p.heartbeatMs = pub["heartbeat_ms"].as<uint32_t>();
+  JsonObject db = pub["deadband"];
+  for (uint8_t i = 0; i < DB_COUNT && !db.isNull(); i++) {
+    if (db.containsKey(PUBLISH_DEADBAND_NAMES[i])) p.deadband[i] = db[PUBLISH_DEADBAND_NAMES[i]].as<float>();
+  }
+}
+
+/* fields present in cfg over p, the others keep their value */
+void mergeDetectionParams(JsonObject cfg, detectionParams_t& p) {
+  if (cfg.containsKey("impact_g")) p.impactG = cfg["impact_g"].as<float>();
+  if (cfg.containsKey("impact_slope_g")) p.impactSlopeG = cfg["impact_slope_g"].as<float>();
+  if (cfg.containsKey("gyro_spike")) p.gyroSpike = cfg["gyro_spike"].as<float>();
+  if (cfg.containsKey("fall_cooldown_ms")) p.fallCooldownMs = cfg["fall_cooldown_ms"].as<uint32_t>();
+  if (cfg.containsKey("alpha")) p.alpha = cfg["alpha"].as<float>();
+  if (cfg.containsKey("sensor_interval_ms")) p.sensorIntervalMs = cfg["sensor_interval_ms"].as<uint32_t>();
+  if (cfg.containsKey("temp_threshold")) p.tempThreshold = cfg["temp_threshold"].as<float>();
+  JsonObject pub = cfg["publish"];
+  if (!pub.isNull()) mergePublishParams(pub, p.publish);
+}
+
+/* NVS follows the staged set; unchanged values cost no flash write */
+void saveDetectionParams(const detectionParams_t& p) {
+  config.setU32("cfg_ver", p.version);
+  config.setFloat("impact_g", p.impactG);
+  config.setFloat("slope_g", p.impactSlopeG);
+  config.setFloat("gyro_spike", p.gyroSpike);
+  config.setU32("fall_cd", p.fallCooldownMs);
+  config.setFloat("alpha", p.alpha);
+  config.setU32("sens_int", p.sensorIntervalMs);
+  config.setFloat("temp_th", p.tempThreshold);
+  config.setU32("pub_min", p.publish.minMs);
+  config.setU32("pub_active", p.publish.activeMs);
+  config.setU32("pub_hb", p.publish.heartbeatMs);
+  for (uint8_t i = 0; i < DB_COUNT; i++) config.setFloat(DEADBAND_KEYS[i], p.publish.deadband[i]);
+}
+
+void answerConfig(uint32_t version, const char* status, const char* error) {
+  configAck.due = true;
+  configAck.version = version;
+  configAck.status = status;
+  configAck.error = error;
+}
+
+/* validate as a whole, hand over to the sensing task; answered once it is in use */
+void stageDetectionParams(const detectionParams_t& p) {
+  const char* bad = DetectionConfig::validate(p);
+  if (bad) {
+    answerConfig(p.version, "rejected", bad);
+    return;
+  }
+  /* the sensing task takes a staged set at its next tick; while the previous
+     one is still waiting, this one waits for the network loop, a newer one replaces it */
+  if (!detection.stage(p)) {
+    configWaiting = p;
+    configWaitingSet = true;
+    return;
+  }
+  configWaitingSet = false;
+  saveDetectionParams(p);
+  answerConfig(p.version, "applied", NULL);
+}
+
+/* every network pass; never inside messageReceived(), where waiting holds up client.loop() */
+void stageWaitingConfig() {
+  if (configWaitingSet) stageDetectionParams(configWaiting);
+}
+
+/* {"config":{"schema":1,"version":N,..}}, see DetectionConfig.h */
+void applyConfigCommand(JsonObject cfg) {
+  detectionParams_t p = configWaitingSet ? configWaiting : detection.latest();
+  uint32_t version = cfg["version"] | 0u;
+  if ((cfg["schema"] | DETECTION_SCHEMA) != DETECTION_SCHEMA) {
+    answerConfig(version, "rejected", "schema");
+  } else if (!cfg.containsKey("version")) {
+    answerConfig(0, "rejected", "version");    // unversioned: it would only ever be "current"
+  } else if (version < p.version) {
+    answerConfig(version, "stale", NULL);      // overtaken by a newer revision
+  } else if (version == p.version) {
+    answerConfig(version, "current", NULL);    // a repeat, nothing to do
+  } else {
+    mergeDetectionParams(cfg, p);
+    p.version = version;
+    stageDetectionParams(p);
+  }
+}
+
+/* runs inside client.loop(), i.e. on the network task */
+void messageReceived(String& topic, String& payload) {
+  StaticJsonDocument<1024> doc;   // a full config command with every deadband
+  if (deserializeJson(doc, payload) == DeserializationError::Ok) {
+    JsonObject cfg = doc["config"];
+    if (!cfg.isNull()) applyConfigCommand(cfg);
+    /* the older top-level keys carry no revision; the backend wraps them into a "config" */
+    if (doc.containsKey("temp_threshold") || doc.containsKey("publish")) answerConfig(0, "rejected", "version");
+    /* publishing from inside the callback is not allowed, the network loop answers */
+    const char* format = doc["telemetry_format"];
+    if (format) {
+      if (strcmp(format, "binary") == 0) config.setU32("tel_fmt", TELEMETRY_BINARY);
+      else if (strcmp(format, "json") == 0) config.setU32("tel_fmt", TELEMETRY_JSON);
+    }
+    const char* cmd = doc["cmd"];
+    if (cmd && strcmp(cmd, "profile") == 0) {
+      profileDumpRequested = true;
+      profileResetRequested = doc["reset"] | false;
+    }
+    if (cmd && strcmp(cmd, "telemetry_bench") == 0) benchRequested = true;
+    if (cmd && strcmp(cmd, "live") == 0) liveStart(doc["seconds"] | 60, doc["decimate"] | 1);
+    if (cmd && strcmp(cmd, "config") == 0) answerConfig(detection.latest().version, "current", NULL);
+    if (doc.containsKey("imu_batch")) config.setU32("imu_batch", doc["imu_batch"].as<bool>() ? 1 : 0);
+  }
+}
+
+/* =========================================================
+   SENSING TASK
+   ========================================================= */
+/* a newly switched parameter set: everything derived from it follows before the next sample */
+void detectionSwitched(const detectionParams_t& p) {
+  tempThreshold = p.tempThreshold;
+  PublishPolicyConfig& c = publishPolicy.cfg;
+  c.minMs = p.publish.minMs;
+  c.activeMs = p.publish.activeMs;
+  c.heartbeatMs = p.publish.heartbeatMs;
+  for (uint8_t i = 0; i < DB_COUNT; i++) c.deadband[i] = p.publish.deadband[i];
+
+  if (p.sensorIntervalMs == sensorIntervalMs) return;
+  sensorIntervalMs = p.sensorIntervalMs;
+  if (imuBatcher.flush(imuClosed)) imuBatchQueue.push(imuClosed);   // a batch holds one period only
+  imuBatcher.setPeriod(p.sensorIntervalMs);
+  liveBatcherDecimate = 0;                                           // live batch restarts with the next sample
+  loopTiming.setPeriod(p.sensorIntervalMs * 1000UL);
+
+  /* the slope and the motion energy keep spanning SLOPE_SPAN ms, the energy keeps
+     its time constant; history restarts at the last value, not at 0 */
+  uint8_t lastIdx = (netAccIdx + slopeLag - 1) % slopeLag;
+  float last = netAccHist[lastIdx];
+  MotionRef lastMotion = motionHist[lastIdx];
+  slopeLag = SLOPE_SPAN / p.sensorIntervalMs;
+  if (slopeLag < 1) slopeLag = 1;
+  for (uint8_t i = 0; i < SLOPE_LAG_MAX; i++) {
+    netAccHist[i] = last;
+    motionHist[i] = lastMotion;
+  }
+  netAccIdx = 0;
+  motionAlpha = 1 - expf(-(float)p.sensorIntervalMs / MOTION_TAU_MS);
+}
+
+/* the slow boards count once per fresh reading, not once per sensing tick */
+void windowEnvironment() {
+  if (env.baroTime != windowEnvSeen.baroTime) window.ch[AGG_PRESSURE].add(env.pressureHpa);
+  if (env.humTime != windowEnvSeen.humTime) window.ch[AGG_HUMIDITY].add(env.humidity);
+  if (env.airTime != windowEnvSeen.airTime) {
+    window.ch[AGG_CO2].add(env.co2);
+    window.ch[AGG_TVOC].add(env.tvoc);
+  }
+  if (env.lightTime != windowEnvSeen.lightTime) window.ch[AGG_LIGHT].add(env.ambientLight);
+  windowEnvSeen = env;
+}
+
+/* =====================================================
+   🌡 TEMPERATURE ALERT (FIXED)
+   ===================================================== */
+void temperatureAlert(float tempC, float threshold, unsigned long now) {
+  if (tempC >= threshold && !tempAlertSent) {
+    raiseAlert(ALERT_HIGH_TEMPERATURE, now, tempC);
+    tempAlertSent = true;
+    lastTempAlertTime = now;
+  }
+
+  if (tempC < threshold - 0.5f) {
+    tempAlertSent = false;
+  }
+}
+
+/* hands a sample the publish policy asked for to the network task, the window starts over */
+void queueTelemetry(const TelemetrySample& s, const float watched[PV_COUNT]) {
+  telemetryQueue.push(s);
+  window.reset(s.time);
+  publishPolicy.published(s.time, watched);
+}
+
+void sampleOnce(const uint8_t* burst, unsigned long now) {
+  const detectionParams_t& dp = detection.active();
+  /* -------- RAW SENSOR (one 14 byte burst, read last tick) -------- */
+  int16_t raw[MPU6050_SAMPLE_WORDS];
+  mpu6050Sample_t imu;
+  {
+    PROFILE_SCOPE(PROF_CONVERT);
+    AccelAndGyro::unpackSample(burst, raw);
+    Ag->convertSample(raw, &imu);
+  }
+  if (!firstSampleMs) firstSampleMs = now;
+
+  /* -------- FULL-RATE IMU BATCH -------- */
+  if (imuBatchEnabled) {
+    if (imuBatcher.add(raw, now, imuClosed)) imuBatchQueue.push(imuClosed);
+  } else {
+    imuBatcher.reset();
+  }
+
+  /* -------- LIVE VIEW -------- */
+  uint32_t liveEnd = liveUntil;
+  if (liveEnd != 0 && (long)(liveEnd - now) > 0) {
+    uint8_t k = liveDecimate;
+    if (k != liveBatcherDecimate) {
+      if (liveBatcher.flush(liveClosed)) liveQueue.push(liveClosed);
+      liveBatcher.setPeriod(sensorIntervalMs * k);
+      liveBatcherDecimate = k;
+      liveTick = 0;
+    }
+    if (liveTick++ % k == 0) {
+      if (liveBatcher.add(raw, now, liveClosed)) {
+        liveQueue.push(liveClosed);
+      } else if (now - liveBatcher.startedAt() >= LIVE_BATCH_MS && liveBatcher.flush(liveClosed)) {
+        liveQueue.push(liveClosed);
+      }
+    }
+  } else if (liveBatcher.flush(liveClosed)) {
+    liveQueue.push(liveClosed);
+  }
+
+  float ax = imu.accelX, ay = imu.accelY, az = imu.accelZ;
+  float gx = imu.gyroX,  gy = imu.gyroY,  gz = imu.gyroZ;
+  float tx = imu.tiltX,  ty = imu.tiltY,  tz = imu.tiltZ;
+  float tempC = imu.tempC;
+  float netAcc, gyroMag, accSlope;
+
+  {
+    PROFILE_SCOPE(PROF_FILTER);
+
+    /* -------- FILTER -------- */
+    float alpha = dp.alpha;
+    ax_f = alpha * ax + (1 - alpha) * ax_f;
+    ay_f = alpha * ay + (1 - alpha) * ay_f;
+    az_f = alpha * az + (1 - alpha) * az_f;
+
+    /* -------- MAGNITUDES -------- */
+    netAcc = magnitude(
+      ax - gravityX,
+      ay - gravityY,
+      az - gravityZ
+    );
+
+    gyroMag = magnitude(gx, gy, gz);
+    accSlope = netAcc - netAccHist[netAccIdx];
+    netAccHist[netAccIdx] = netAcc;
+
+    /* -------- MOTION ENERGY (orientation independent) -------- */
+    MotionRef& ref = motionHist[netAccIdx];
+    float jerk = magnitude(ax - ref.ax, ay - ref.ay, az - ref.az) +
+                 GYRO_ENERGY_K * magnitude(gx - ref.gx, gy - ref.gy, gz - ref.gz);
+    motionEnergy = motionAlpha * jerk + (1 - motionAlpha) * motionEnergy;
+    ref = { ax, ay, az, gx, gy, gz };
+    netAccIdx = (netAccIdx + 1) % slopeLag;
+  }
+
+  /* fall detector inputs on the binary trace channel (MYOSA_TRACE_ENABLE builds only) */
+  MYOSA_TRACE(TRACE_NET_ACC, netAcc * 1000);
+  MYOSA_TRACE(TRACE_ACC_SLOPE, accSlope * 1000);
+  MYOSA_TRACE(TRACE_GYRO_MAG, gyroMag * 10);
+
+  /* -------- WINDOW AGGREGATES -------- */
+  float threshold = tempThreshold;
+  window.ch[AGG_ACC_X].add(ax_f);
+  window.ch[AGG_ACC_Y].add(ay_f);
+  window.ch[AGG_ACC_Z].add(az_f);
+  window.ch[AGG_NET_ACC].add(netAcc, dp.impactG);
+  window.ch[AGG_GYRO].add(gyroMag, dp.gyroSpike);
+  window.ch[AGG_TEMP].add(tempC, threshold);
+  windowEnvironment();
+
+  PROFILE_SCOPE(PROF_DETECT);
 
   /* =====================================================
      🚨 BABY FALL DETECTION (REAL-TIME)
      ===================================================== */
   if (
-    netAcc > IMPACT_G &&
-    accSlope > IMPACT_SLOPE_G &&
-    gyroMag > GYRO_SPIKE &&
-    (now - lastFallTime) > FALL_COOLDOWN
+    netAcc > dp.impactG &&
+    accSlope > dp.impactSlopeG &&
+    gyroMag > dp.gyroSpike &&
+    (now - lastFallTime) > dp.fallCooldownMs
   ) {
     lastFallTime = now;
+    lastFallAlertTime = now;
+    raiseAlert(ALERT_FALL_IMPACT, now, netAcc * gyroMag);
+
+    /* a new impact always (re)opens the post-fall window */
+    postFallStart(now);
+  }
 
-    StaticJsonDocument<128> alert;
-    alert["alert"] = "fall_impact";
-    alert["status"] = true;
-    alert["severity_score"] = netAcc * gyroMag;
+  postFallUpdate(now);
 
-    char buf[128];
-    serializeJson(alert, buf);
-    publishMessage(TOPIC_ALERT, buf);
+  temperatureAlert(tempC, threshold, now);
 
-    Serial.println("🚨 BABY FALL ALERT SENT");
+  /* ---------------- TELEMETRY (change driven) ---------------- */
+  float watched[PV_COUNT] = {
+    tempC, tx, ty, tz, motionEnergy,
+    env.pressureHpa, env.humidity, (float)env.co2, (float)env.ambientLight
+  };
+  bool elevated = postFall.active || tempAlertSent || motionEnergy > MOVE_ENERGY ||
+                  (lastFallTime != 0 && now - lastFallTime < ALERT_COOLDOWN);
+  PublishReason reason = publishPolicy.check(now, watched, elevated);
+  if (reason != PUBLISH_NONE) {
+    TelemetrySample s = {
+      now,
+      ax_f, ay_f, az_f, netAcc,
+      gx, gy, gz, gyroMag,
+      tx, ty, tz,
+      tempC, threshold,
+      env,
+      window,
+      reason,
+      true
+    };
+    queueTelemetry(s, watched);
   }
+}
 
-  /* =====================================================
-     🌡 TEMPERATURE ALERT (FIXED)
-     ===================================================== */
-  if (tempC >= tempThreshold && !tempAlertSent) {
-    StaticJsonDocument<128> alert;
-    alert["alert"] = "high_temperature";
-    alert["status"] = true;
-    alert["temperature"] = tempC;
+/* without an IMU the slow boards still report: environment only telemetry,
+   and the temperature alert runs on their air temperature instead */
+void sampleEnvironment(unsigned long now) {
+  float tempC = env.humTime ? env.humTempC : env.baroTime ? env.baroTempC : NAN;
+  float threshold = tempThreshold;
+  bool fresh = env.humTime != windowEnvSeen.humTime || env.baroTime != windowEnvSeen.baroTime;
+  if (fresh && !isnan(tempC)) window.ch[AGG_TEMP].add(tempC, threshold);
+  windowEnvironment();
 
-    char buf[128];
-    serializeJson(alert, buf);
-    publishMessage(TOPIC_ALERT, buf);
+  PROFILE_SCOPE(PROF_DETECT);
+  temperatureAlert(tempC, threshold, now);
 
-    tempAlertSent = true;
-    Serial.println("🌡 TEMPERATURE ALERT SENT");
+  float watched[PV_COUNT] = {
+    tempC, NAN, NAN, NAN, 0,
+    env.pressureHpa, env.humidity, (float)env.co2, (float)env.ambientLight
+  };
+  PublishReason reason = publishPolicy.check(now, watched, tempAlertSent);
+  if (reason != PUBLISH_NONE) {
+    TelemetrySample s = {
+      now,
+      NAN, NAN, NAN, NAN,
+      NAN, NAN, NAN, NAN,
+      NAN, NAN, NAN,
+      tempC, threshold,
+      env,
+      window,
+      reason,
+      false
+    };
+    queueTelemetry(s, watched);
   }
+}
 
-  if (tempC < tempThreshold - 0.5f) {
-    tempAlertSent = false;
+/* two bursts in flight: one on the bus, one being processed */
+struct ImuSlot {
+  uint8_t burst[MPU6050_SAMPLE_BYTES];
+  I2cTransfer xfer;
+  unsigned long time;
+  bool valid;
+};
+ImuSlot imuSlots[2];
+uint8_t imuCur = 0;
+
+void sensingTask(void* arg) {
+  TickType_t lastWake = xTaskGetTickCount();
+  for (;;) {
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(sensorIntervalMs));
+    /* between samples: a staged parameter set takes over as a whole */
+    if (detection.apply()) detectionSwitched(detection.active());
+    uint32_t t0 = (uint32_t)esp_timer_get_time();
+    loopTiming.begin(t0);
+    unsigned long now = millis();
+
+    /* start this tick's burst, work on the last one while it is on the bus;
+       samples keep their read time, detection runs one tick (10 ms) later */
+    ImuSlot& cur = imuSlots[imuCur];
+    ImuSlot& prev = imuSlots[imuCur ^ 1];
+    cur.time = now;
+    cur.valid = false;
+    bool queued = Ag && i2cBus.submit(&cur.xfer);
+    if (prev.valid) sampleOnce(prev.burst, prev.time);
+    if (queued) {
+      PROFILE_SCOPE(PROF_I2C_READ);   // only the part of the transfer not hidden behind sampleOnce()
+      cur.valid = i2cBus.wait(&cur.xfer, sensorIntervalMs) && cur.xfer.ok();
+    }
+    imuCur ^= 1;
+
+    /* slow boards only get what is left of this tick, the IMU always goes first;
+       the burst is finished by now; I2cBus would serialise them with it anyway */
+    {
+      PROFILE_SCOPE(PROF_SLOW_SENSORS);
+      scheduler.run(now, SLOW_SENSOR_BUDGET_US);
+    }
+    /* without an IMU the first slow board reading is the first sample */
+    for (uint8_t i = 0; !firstSampleMs && i < scheduler.count(); i++) {
+      if (scheduler.get(i)->readings()) firstSampleMs = now;
+    }
+    if (!Ag) sampleEnvironment(now);
+    uint32_t t1 = (uint32_t)esp_timer_get_time();
+    loopTiming.end(t1);
+    sensingStats.busyUs += t1 - t0;
   }
+}
+
+/* =========================================================
+   NETWORK TASK
+   ========================================================= */
+void networkTask(void* arg) {
+  AlertEvent ev;
+  TelemetrySample s;
+  imuBatch_t batch;
+  timingReport_t timing;
+  for (;;) {
+    uint32_t t0 = (uint32_t)esp_timer_get_time();
+    unsigned long now = millis();
 
-  /* ---------------- TELEMETRY ---------------- */
-  if (now - publishMillis >= PUBLISH_INTERVAL) {
-    publishMillis = now;
+    linkUpdate(now);
+    config.loop(now);
+    stageWaitingConfig();
 
-    StaticJsonDocument<512> data;
+    /* nothing is lost to an outage: while the link is down, or a RAM queue
+       backs up, its messages go to flash. Alerts already in flash are older
+       than those in RAM, so new ones join them there to keep their order */
+    if (alertStore.ready() &&
+        (!linkUp() || !alertStore.empty() || alertQueue.size() >= alertQueue.capacity() / 2)) storeAlerts();
+    if (telemetryStore.ready() &&
+        (!linkUp() || telemetryQueue.size() >= telemetryQueue.capacity() / 2)) storeTelemetry();
 
-    JsonObject acc = data.createNestedObject("acc");
-    acc["x"] = ax_f;
-    acc["y"] = ay_f;
-    acc["z"] = az_f;
-    acc["net"] = netAcc;
+    radio.update(now);
+    if (linkUp()) {
+      /* alerts and answers wake the radio at once; telemetry, IMU data and
+         diagnostics collect until the next aligned burst or a queue fills */
+      bool urgent = alertPending() || statusDue || configAck.due || benchRequested || profileDumpRequested ||
+                    liveUntil != 0 || liveQueue.size() != 0 ||
+                    (telemetryQueue.peek(s) && s.reason == PUBLISH_ACTIVE);
+      bool full = telemetryQueue.size() >= RADIO_BURST_FILL || imuBatchQueue.size() >= IMU_BURST_BATCHES ||
+                  (imuBatchQueue.peek(batch) && now - batch.closedAt >= IMU_BATCH_MAX_AGE);
+      if (urgent || full || radio.burstDue(now)) radio.wake(now, !urgent && !full);
+      bool poll = radio.pollDue(now);
+      if (radio.awake() || poll) client.loop();
+    }
 
-    JsonObject gyro = data.createNestedObject("gyro");
-    gyro["x"] = gx;
-    gyro["y"] = gy;
-    gyro["z"] = gz;
-    gyro["mag"] = gyroMag;
+    if (linkUp() && radio.awake()) {
+      /* alerts first, they must never wait behind telemetry; everything
+         below stops as soon as an alert is waiting */
+      alertStore.drain(STORE_DRAIN_BATCH, publishStoredAlert, NULL, storeRecord, sizeof(storeRecord));
+      while (alertQueue.peek(ev) && publishAlert(ev)) alertQueue.pop(ev);
+      /* a sample that can never go out is dropped, it must not hold up the ones behind it */
+      while (!alertPending() && telemetryQueue.peek(s) && publishTelemetry(s) != SEND_RETRY) telemetryQueue.pop(s);
 
-    JsonObject tilt = data.createNestedObject("tilt");
-    tilt["x"] = tx;
-    tilt["y"] = ty;
-    tilt["z"] = tz;
+      /* the telemetry backlog goes out behind current data, a batch per pass */
+      if (!alertPending()) {
+        telemetryStore.drain(STORE_DRAIN_BATCH, publishStoredTelemetry, NULL, storeRecord, sizeof(storeRecord));
+      }
 
-    data["temp"] = tempC;
-    data["thresTemp"] = tempThreshold;
+      /* full-rate IMU data goes out with the burst, not one message every half second */
+      while (!alertPending() && imuBatchQueue.peek(batch) && publishMessage(TOPIC_IMU, batch.data, batch.len)) {
+        imuDelay.add(millis() - batch.closedAt);
+        imuBatchQueue.pop(batch);
+      }
+
+      /* live view: sent as soon as it is there, the remainder drains after it ends */
+      liveUpdate(now);
+      while (!alertPending() && liveQueue.peek(batch) && publishMessage(TOPIC_LIVE, batch.data, batch.len)) liveQueue.pop(batch);
+
+      if (statusDue && !alertPending() && publishStatus(now)) statusDue = false;
+      if (configAck.due && !detection.pending() && !alertPending() && publishConfigAck(now)) configAck.due = false;
+
+      if (now - diagMillis >= DIAG_INTERVAL) {
+        statusDue = true;              // keeps uptime and sensor health current
+        publishDiagnostics(now);
+        loopTiming.requestReport();
+      }
+      if (loopTiming.takeReport(&timing)) publishTiming(timing);
+
+      if (benchRequested) {
+        benchRequested = false;
+        publishTelemetryBench();
+      }
+      if (profileDumpRequested) {
+        profileDumpRequested = false;
+        publishProfile();
+#if MYOSA_PROFILE
+        if (profileResetRequested) profileReset();
+#endif
+      }
+
+      /* back to modem sleep once the burst is out */
+      bool idle = !alertPending() && telemetryQueue.size() == 0 && imuBatchQueue.size() == 0 &&
+                  liveUntil == 0 && liveQueue.size() == 0 && telemetryStore.empty() &&
+                  !statusDue && !configAck.due;
+      if (!idle) radioBusyAt = now;
+      else if (now - radioBusyAt >= RADIO_LINGER_MS) radio.doze(now);
+    }
 
-    char buf[512];
-    serializeJson(data, buf);
-    publishMessage(TOPIC_SENSOR, buf);
+    networkStats.busyUs += (uint32_t)esp_timer_get_time() - t0;
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(NETWORK_POLL));  // queueAlert() cuts the wait short
   }
 }
+
+/* =========================================================
+   SETUP
+   ========================================================= */
+/* scan the bus, then create and start a driver per identified board;
+   a missing or failing board is recorded for the status message and
+   never holds up the boot */
+void startBoards() {
+  uint8_t found = boards.scan();
+  Serial.print("🔎 I2C scan: ");
+  Serial.print(found);
+  Serial.print(" of ");
+  Serial.print(BOARD_COUNT);
+  Serial.print(" boards in ");
+  Serial.print(boards.scanUs());
+  Serial.println(" us");
+
+  if (boards.found(BOARD_IMU)) {
+    Ag = new AccelAndGyro(boards.address(BOARD_IMU));
+    if (boards.started(BOARD_IMU, Ag->begin())) {
+      imuBatcher.setScale(Ag->getFullScaleAccelRange(), Ag->getFullScaleGyroRange());
+      liveBatcher.setScale(Ag->getFullScaleAccelRange(), Ag->getFullScaleGyroRange());
+    } else {
+      delete Ag;
+      Ag = NULL;
+    }
+  }
+  if (boards.found(BOARD_BARO)) {
+    Pr = new BarometricPressure(ULTRA_HIGH_RESOLUTION);
+    if (boards.started(BOARD_BARO, Pr->begin())) {
+      scheduler.add(new BaroSensor(*Pr, env, BARO_INTERVAL));
+    } else {
+      delete Pr;
+      Pr = NULL;
+    }
+  }
+  if (boards.found(BOARD_HUMIDITY)) {
+    Th = new TempAndHumidity();
+    if (boards.started(BOARD_HUMIDITY, Th->begin())) {
+      scheduler.add(new HumiditySensor(*Th, env, HUMIDITY_INTERVAL));
+    } else {
+      delete Th;
+      Th = NULL;
+    }
+  }
+  if (boards.found(BOARD_AIR)) {
+    Aq = new AirQuality(boards.address(BOARD_AIR));
+    if (boards.started(BOARD_AIR, Aq->begin() == SENSOR_SUCCESS)) {
+      scheduler.add(new AirSensor(*Aq, env, AIR_INTERVAL));
+    } else {
+      delete Aq;
+      Aq = NULL;
+    }
+  }
+  if (boards.found(BOARD_LIGHT)) {
+    Lp = new LightProximityAndGesture();
+    bool ok = Lp->begin() && Lp->enableAmbientLightSensor(DISABLE) && Lp->enableProximitySensor(DISABLE);
+    if (boards.started(BOARD_LIGHT, ok)) {
+      scheduler.add(new LightSensor(*Lp, env, LIGHT_INTERVAL));
+    } else {
+      delete Lp;
+      Lp = NULL;
+    }
+  }
+
+  for (uint8_t b = 0; b < BOARD_COUNT; b++) {
+    if (boards.ready((BoardId)b)) continue;
+    Serial.print("⚠️ ");
+    Serial.print(boards.name((BoardId)b));
+    Serial.print(": ");
+    Serial.println(BoardScan::stateName(boards.state((BoardId)b)));
+  }
+}
+
+void setup() {
+  Serial.begin(115200);
+  I2cBus::shared().begin();    // standard mode for the board scan, drivers raise it as they attach
+
+  config.addU32("tel_fmt", &telemetryFormat);
+  config.addU32("imu_batch", &imuBatchEnabled);
+  config.addU32("boot", &bootCount);
+  /* the parameter set is stored as staged; the live copies follow when it is switched in */
+  config.addU32("cfg_ver", &detectionSaved.version);
+  config.addFloat("impact_g", &detectionSaved.impactG);
+  config.addFloat("slope_g", &detectionSaved.impactSlopeG);
+  config.addFloat("gyro_spike", &detectionSaved.gyroSpike);
+  config.addU32("fall_cd", &detectionSaved.fallCooldownMs);
+  config.addFloat("alpha", &detectionSaved.alpha);
+  config.addU32("sens_int", &detectionSaved.sensorIntervalMs);
+  config.addFloat("temp_th", &detectionSaved.tempThreshold);
+  config.addU32("pub_min", &detectionSaved.publish.minMs);
+  config.addU32("pub_active", &detectionSaved.publish.activeMs);
+  config.addU32("pub_hb", &detectionSaved.publish.heartbeatMs);
+  for (uint8_t i = 0; i < DB_COUNT; i++) config.addFloat(DEADBAND_KEYS[i], &detectionSaved.publish.deadband[i]);
+  config.begin();
+  /* written at once: alert keys of this boot must never repeat those of the last */
+  config.setU32("boot", bootCount + 1);
+  config.flush();
+
+  /* a stored set outside today's limits falls back to the built-in defaults */
+  const char* bad = DetectionConfig::validate(detectionSaved);
+  if (bad) {
+    Serial.print("⚠ stored config rejected: ");
+    Serial.println(bad);
+    detectionSaved = detectionDefaults();
+  }
+  detection.stage(detectionSaved);
+  detection.apply();
+  detectionSwitched(detection.active());
+
+  /* formats the partition on first use; each lane that does not start holds
+     its messages in RAM only, the other one is not affected */
+  if (!LittleFS.begin(true)) {
+    Serial.println("⚠ flash store unavailable");
+  } else {
+    if (!alertStore.begin()) Serial.println("⚠ alert store unavailable");
+    if (!telemetryStore.begin()) Serial.println("⚠ telemetry store unavailable");
+  }
+  tempAlertSent = false;  // FORCE RESET
+
+  /* the network task brings the link up, setup() never waits on it */
+  WiFi.mode(WIFI_STA);
+  WiFi.setAutoReconnect(false);
+  wallClockBegin(ntp_server1, ntp_server2);  // syncs in the background once Wi-Fi is up
+  net.setCACert(mqtt_ca_cert);
+  client.begin(mqtt_server, mqtt_port, net);
+  client.setTimeout(MQTT_COMMAND_TIMEOUT);
+  client.setKeepAlive(MQTT_KEEPALIVE_S);
+  client.setWill(TOPIC_STATUS, STATUS_OFFLINE, true, 1);
+  client.onMessage(messageReceived);
+
+  startBoards();
+
+  /* Gravity calibration, over the bursts that were read: a failed read must not pull it towards 0 */
+  float sx=0, sy=0, sz=0;
+  int got = 0;
+  for (int i=0; Ag && i<30; i++) {
+    mpu6050Sample_t s;
+    if (Ag->getSample(&s)) {
+      sx += s.accelX;
+      sy += s.accelY;
+      sz += s.accelZ;
+      got++;
+    }
+    delay(20);
+  }
+  if (got > 0) {
+    gravityX = sx/got;
+    gravityY = sy/got;
+    gravityZ = sz/got;
+  } else if (Ag) {
+    Serial.println("⚠️ IMU unreadable, gravity not calibrated");
+  } else {
+    Serial.println("⚠️ No IMU: environment telemetry only, no fall detection");
+  }
+  for (uint8_t i = 0; i < SLOPE_LAG_MAX; i++) motionHist[i] = { gravityX, gravityY, gravityZ, 0, 0, 0 };
+
+  for (uint8_t i = 0; Ag && i < 2; i++) {
+    imuSlots[i].xfer.read(Ag->getI2CAddress(), MPU6050_ACCEL_XOUT_H_REG, imuSlots[i].burst, MPU6050_SAMPLE_BYTES);
+    imuSlots[i].valid = false;
+  }
+  /* same core as the sensing task and above it: takes a transfer at once and
+     hands the core back while the peripheral clocks the bytes */
+  i2cBus.begin(SENSING_CORE, I2C_PRIORITY);
+
+  diagMillis = millis();
+  netLink.downSince = diagMillis;
+  xTaskCreatePinnedToCore(sensingTask, "sensing", SENSING_STACK, NULL,
+                          SENSING_PRIORITY, &sensingStats.handle, SENSING_CORE);
+  xTaskCreatePinnedToCore(networkTask, "network", NETWORK_STACK, NULL,
+                          NETWORK_PRIORITY, &networkStats.handle, NETWORK_CORE);
+
+  setupDoneMs = millis();
+  Serial.print("✅ Baby fall & temperature system READY after ");
+  Serial.print(setupDoneMs);
+  Serial.println(" ms");
+}
+
+/* =========================================================
+   LOOP
+   ========================================================= */
+void loop() {
+  /* all work happens in sensingTask / networkTask */
+  vTaskDelete(NULL);
+}
@@ -26,6 +26,23 @@
 
 #include "AccelAndGyro.h"
 
+/**
+ * Default configuration written by begin(), in table order. Adjacent registers share one burst.
+ * PWR_MGMT_1 goes first: PLL on the X gyro, and SLEEP, CYCLE and TEMP_DIS cleared.
+ */
+static const i2cRegValue_t mpu6050Defaults[] =
+{
+	{ MPU6050_PWR_MGMT_1_REG,	MPU6050_CLOCK_PLL_XGYRO << MPU_PWR_MGMT_1_CLKSEL_POS,		0xFFu },
+	{ MPU6050_GYRO_CONFIG_REG,	MPU_GYRO_CONFIG_FS_SEL_250 << MPU_GYRO_CONFIG_FS_SEL_POS,	0xFFu },
+	{ MPU6050_ACCEL_CONFIG_REG,	MPU_ACCEL_CONFIG_FS_SEL_2g << MPU_ACCEL_CONFIG_FS_SEL_POS,	0xFFu },
+	{ MPU6050_MOTION_THR,		2u,															0xFFu },
+	{ MPU6050_MOTION_DUR,		40u,														0xFFu },
+	{ MPU6050_ZERO_MOTION_THR,	2u,															0xFFu },
+	{ MPU6050_ZERO_MOTION_DUR,	1u,															0xFFu },
+	/* motion interrupt only */
+	{ MPU6050_INT_ENABLE,		MPU_INT_MOTION_DETECT_MSK,									0xFFu },
+};
+
 /**
  *
  */
@@ -33,6 +50,8 @@ AccelAndGyro::AccelAndGyro(uint8_t i2c_add)
 {
 	_i2cSlaveAddress	= i2c_add;
 	_isConnected		= false;
+	_accelFsr			= MPU_ACCEL_CONFIG_FS_SEL_2g;
+	_gyroFsr			= MPU_GYRO_CONFIG_FS_SEL_250;
 	/* 1g = 9.80665 m/s^2 */
 	/* Update the Accelerometer and Gyrometer scale factors */
 	for(uint32_t fsr_sel=0u; fsr_sel < 4u; fsr_sel++)
@@ -40,6 +59,7 @@ AccelAndGyro::AccelAndGyro(uint8_t i2c_add)
 		_gyroScale[fsr_sel] = (250.f*(float)(1u << (fsr_sel+1u)))/32768.f;
 		_accelScale[fsr_sel] = (2.f*9.80665f*(float)(1u << (fsr_sel+1u)))/32768.f;
 	}
+	i2c_init();
 }
 
 /**
@@ -47,46 +67,13 @@ AccelAndGyro::AccelAndGyro(uint8_t i2c_add)
  */
 bool AccelAndGyro::begin(bool calibrate)
 {
-	if(setClkSource(MPU6050_CLOCK_PLL_XGYRO) == false)
-	{
-		return false;
-	}
-	if(setFullScaleGyroRange(MPU_GYRO_CONFIG_FS_SEL_250) == false)
-	{
-		return false;
-	}
-	if(setFullScaleAccelRange(MPU_ACCEL_CONFIG_FS_SEL_2g) == false)
-	{
-		return false;
-	}
-	if(setSleep(false) == false)
-	{
-		return false;
-	}
-	if(setIntZeroMotionEnabled(false) == false)
-	{
-		return false;
-	}
-	if(setIntMotionEnabled(true) == false)
-	{
-		return false;
-	}
-	if(setMotionDetectionThreshold(2) == false)
-	{
-		return false;
-	}
-	if(setZeroMotionDetectionThreshold(2) == false)
-	{
-		return false;
-	}
-	if(setMotionDetectionDuration(40) == false)
-	{
-		return false;
-	}
-	if(setZeroMotionDetectionDuration(1) == false)
+	/* four bursts and four read-backs instead of ten read-modify-writes */
+	if(writeTable(mpu6050Defaults, sizeof(mpu6050Defaults)/sizeof(mpu6050Defaults[0])) == false)
 	{
 		return false;
 	}
+	_gyroFsr	= MPU_GYRO_CONFIG_FS_SEL_250;
+	_accelFsr	= MPU_ACCEL_CONFIG_FS_SEL_2g;
 	/* Calibrate the sensor if required */
 	if(calibrate)
 	{
@@ -103,20 +90,20 @@ bool AccelAndGyro::accelGyroCalibrate(void)
 {
 	float sumAx=0.f,sumAy=0.f,sumAz=0.f;
 	float sumGx=0.f,sumGy=0.f,sumGz=0.f;
-	getAccelX(false);
-	getAccelY(false);
-	getAccelZ(false);
-	getGyroX(false);
-	getGyroY(false);
-	getGyroZ(false);
+	getAccelX();
+	getAccelY();
+	getAccelZ();
+	getGyroX();
+	getGyroY();
+	getGyroZ();
 	for(uint8_t nReading=0u; nReading < CALIBRATION_READINGS; nReading++)
 	{
-		sumAx += getAccelX(false);
-		sumAy += getAccelY(false);
-		sumAz += getAccelZ(false);
-		sumGx += getGyroX(false);
-		sumGy += getGyroY(false);
-		sumGz += getGyroZ(false);
+		sumAx += getAccelX();
+		sumAy += getAccelY();
+		sumAz += getAccelZ();
+		sumGx += getGyroX();
+		sumGy += getGyroY();
+		sumGz += getGyroZ();
 		delay_ms(20);
 	}
 	float meanAx, meanAy, meanAz;
@@ -127,19 +114,13 @@ bool AccelAndGyro::accelGyroCalibrate(void)
 	meanGx = sumGx/CALIBRATION_READINGS;
 	meanGy = sumGy/CALIBRATION_READINGS;
 	meanGz = sumGz/CALIBRATION_READINGS;
-	Serial.println("Calibrate values");
-	Serial.print("meanAx:");
-	Serial.println(meanAx,2);
-	Serial.print("meanAy:");
-	Serial.println(meanAy,2);
-	Serial.print("meanAx:");
-	Serial.println(meanAz,2);
-	Serial.print("meanAz:");
-	Serial.println(meanGx,2);
-	Serial.print("meanGx:");
-	Serial.println(meanGy,2);
-	Serial.print("meanGz:");
-	Serial.println(meanGz,2);
+	MYOSA_LOGD("Calibrate values");
+	MYOSA_LOGD("meanAx:", meanAx);
+	MYOSA_LOGD("meanAy:", meanAy);
+	MYOSA_LOGD("meanAz:", meanAz);
+	MYOSA_LOGD("meanGx:", meanGx);
+	MYOSA_LOGD("meanGy:", meanGy);
+	MYOSA_LOGD("meanGz:", meanGz);
 	return true;
 }
 
@@ -238,7 +219,12 @@ bool AccelAndGyro::setFullScaleGyroRange(uint8_t range)
 	}
 	gyroConfig &= ~MPU_GYRO_CONFIG_FS_SEL_MASK;
 	gyroConfig |= (range << MPU_GYRO_CONFIG_FS_SEL_POS);
-	return writeByte(MPU6050_GYRO_CONFIG_REG,gyroConfig);
+	if(writeByte(MPU6050_GYRO_CONFIG_REG,gyroConfig) == false)
+	{
+		return false;
+	}
+	_gyroFsr = range & 0x03u;
+	return true;
 }
 
 /**
@@ -268,7 +254,12 @@ bool AccelAndGyro::setFullScaleAccelRange(uint8_t range)
 	}
 	accelConfig &= ~MPU_ACCEL_CONFIG_FS_SEL_MASK;
 	accelConfig |= (range << MPU_ACCEL_CONFIG_FS_SEL_POS);
-	return writeByte(MPU6050_ACCEL_CONFIG_REG,accelConfig);
+	if(writeByte(MPU6050_ACCEL_CONFIG_REG,accelConfig) == false)
+	{
+		return false;
+	}
+	_accelFsr = range & 0x03u;
+	return true;
 }
 
 /**
@@ -827,168 +818,144 @@ bool AccelAndGyro::getIntZeroMotionStatus(void)
 /**
  *
  */
-float AccelAndGyro::getAccelX(bool print)
+float AccelAndGyro::getAccelX(void)
 {
-	int8_t data[2u];
+	uint8_t data[2u];
 	uint8_t fsrSel;
 	int16_t raw=0;
 	float aX = 0.0f;
-	if(readMultiBytes(MPU6050_ACCEL_XOUT_H_REG,2u,(uint8_t *)data))
+	if(readMultiBytes(MPU6050_ACCEL_XOUT_H_REG,2u,data) == false)
 	{
-		raw = (data[0u] << 8)| data[1u];
+		return NAN;
 	}
+	raw = (int16_t)((data[0u] << 8)| data[1u]);
 	fsrSel =  getFullScaleAccelRange();
 	if(fsrSel == 0x0Fu)
 	{
-		return 0.0f;
+		return NAN;
 	}
 	aX = (float)raw * _accelScale[fsrSel] * 100.f;
-	if(print)
-	{
-		Serial.print("Acceleration(X): ");
-		Serial.print(aX,2);
-		Serial.println("cm/s^2");
-	}
+	MYOSA_LOGI("Acceleration(X): ", aX, "cm/s^2");
 	return aX;
 }
 
 /**
  *
  */
-float AccelAndGyro::getAccelY(bool print)
+float AccelAndGyro::getAccelY(void)
 {
-	int8_t data[2u];
+	uint8_t data[2u];
 	uint8_t fsrSel;
 	int16_t raw=0;
 	float aY = 0.0f;
-	if(readMultiBytes(MPU6050_ACCEL_YOUT_H_REG,2u,(uint8_t *)data))
+	if(readMultiBytes(MPU6050_ACCEL_YOUT_H_REG,2u,data) == false)
 	{
-		raw = (data[0u] << 8)| data[1u];
+		return NAN;
 	}
+	raw = (int16_t)((data[0u] << 8)| data[1u]);
 	fsrSel =  getFullScaleAccelRange();
 	if(fsrSel == 0x0Fu)
 	{
-		return 0.0f;
+		return NAN;
 	}
 	aY = (float)raw * _accelScale[fsrSel] * 100.f;
-	if(print)
-	{
-		Serial.print("Acceleration(Y): ");
-		Serial.print(aY,2);
-		Serial.println("cm/s^2");
-	}
+	MYOSA_LOGI("Acceleration(Y): ", aY, "cm/s^2");
 	return aY;
 }
 
 /**
  *
  */
-float AccelAndGyro::getAccelZ(bool print)
+float AccelAndGyro::getAccelZ(void)
 {
-	int8_t data[2u];
+	uint8_t data[2u];
 	uint8_t fsrSel;
 	int16_t raw=0;
 	float aZ = 0.0f;
-	if(readMultiBytes(MPU6050_ACCEL_ZOUT_H_REG,2u,(uint8_t *)data))
+	if(readMultiBytes(MPU6050_ACCEL_ZOUT_H_REG,2u,data) == false)
 	{
-		raw = (data[0u] << 8)| data[1u];
+		return NAN;
 	}
+	raw = (int16_t)((data[0u] << 8)| data[1u]);
 	fsrSel =  getFullScaleAccelRange();
 	if(fsrSel == 0x0Fu)
 	{
-		return 0.0f;
+		return NAN;
 	}
 	aZ = (float)raw * _accelScale[fsrSel] * 100.f;
-	if(print)
-	{
-		Serial.print("Acceleration(Z): ");
-		Serial.print(aZ,2);
-		Serial.println("cm/s^2");
-	}
+	MYOSA_LOGI("Acceleration(Z): ", aZ, "cm/s^2");
 	return aZ;
 }
 
 /**
  *
  */
-float AccelAndGyro::getGyroX(bool print)
+float AccelAndGyro::getGyroX(void)
 {
-	int8_t data[2u];
+	uint8_t data[2u];
 	uint8_t fsrSel;
 	int16_t raw=0;
 	float gX = 0.0f;
-	if(readMultiBytes(MPU6050_GYRO_XOUT_H_REG,2u,(uint8_t *)data))
+	if(readMultiBytes(MPU6050_GYRO_XOUT_H_REG,2u,data) == false)
 	{
-		raw = (data[0u] << 8)| data[1u];
+		return NAN;
 	}
+	raw = (int16_t)((data[0u] << 8)| data[1u]);
 	fsrSel =  getFullScaleGyroRange();
 	if(fsrSel == 0x0Fu)
 	{
-		return 0.0f;
+		return NAN;
 	}
 	gX = (float)raw * _gyroScale[fsrSel];
-	if(print)
-	{
-		Serial.print("Angular Velocity(X): ");
-		Serial.print(gX,2);
-		Serial.println("°/s");
-	}
+	MYOSA_LOGI("Angular Velocity(X): ", gX, "°/s");
 	return gX;
 }
 
 /**
  *
  */
-float AccelAndGyro::getGyroY(bool print)
+float AccelAndGyro::getGyroY(void)
 {
-	int8_t data[2u];
+	uint8_t data[2u];
 	uint8_t fsrSel;
 	int16_t raw=0;
 	float gY = 0.0f;
-	if(readMultiBytes(MPU6050_GYRO_YOUT_H_REG,2u,(uint8_t *)data))
+	if(readMultiBytes(MPU6050_GYRO_YOUT_H_REG,2u,data) == false)
 	{
-		raw = (data[0u] << 8)| data[1u];
+		return NAN;
 	}
+	raw = (int16_t)((data[0u] << 8)| data[1u]);
 	fsrSel =  getFullScaleGyroRange();
 	if(fsrSel == 0x0Fu)
 	{
-		return 0.0f;
-	}
-	gY = (float)raw * _accelScale[fsrSel] * 100.f;
-	if(print)
-	{
-		Serial.print("Angular Velocity(Y): ");
-		Serial.print(gY,2);
-		Serial.println("°/s");
+		return NAN;
 	}
+	gY = (float)raw * _gyroScale[fsrSel];
+	MYOSA_LOGI("Angular Velocity(Y): ", gY, "°/s");
 	return gY;
 }
 
 /**
  *
  */
-float AccelAndGyro::getGyroZ(bool print)
+float AccelAndGyro::getGyroZ(void)
 {
-	int8_t data[2u];
+	uint8_t data[2u];
 	uint8_t fsrSel;
 	int16_t raw=0;
 	float gZ = 0.0f;
-	if(readMultiBytes(MPU6050_GYRO_ZOUT_H_REG,2u,(uint8_t *)data))
+	if(readMultiBytes(MPU6050_GYRO_ZOUT_H_REG,2u,data) == false)
 	{
-		raw = (data[0u] << 8)| data[1u];
+		return NAN;
 	}
+	raw = (int16_t)((data[0u] << 8)| data[1u]);
 	fsrSel =  getFullScaleGyroRange();
 	if(fsrSel == 0x0Fu)
 	{
-		return 0.0f;
+		return NAN;
 	}
 	gZ = (float)raw * _gyroScale[fsrSel];
-	if(print)
-	{
-		Serial.print("Angular Velocity(Z): ");
-		Serial.print(gZ,2);
-		Serial.println("°/s");
-	}
+	MYOSA_LOGI("Angular Velocity(Z): ", gZ, "°/s");
 	return gZ;
 }
 
@@ -997,12 +964,12 @@ float AccelAndGyro::getGyroZ(bool print)
  */
 bool AccelAndGyro::getAccel(int16_t *aX, int16_t *aY, int16_t *aZ)
 {
-	int8_t accel[6u];
-	if(readMultiBytes(MPU6050_ACCEL_XOUT_H_REG,6u,(uint8_t *)accel))
+	uint8_t accel[6u];
+	if(readMultiBytes(MPU6050_ACCEL_XOUT_H_REG,6u,accel))
 	{
-		*aX = (accel[0u] << 8)| accel[1u];
-		*aY = (accel[2u] << 8)| accel[3u];
-		*aZ = (accel[4u] << 8)| accel[5u];
+		*aX = (int16_t)((accel[0u] << 8)| accel[1u]);
+		*aY = (int16_t)((accel[2u] << 8)| accel[3u]);
+		*aZ = (int16_t)((accel[4u] << 8)| accel[5u]);
 		return true;
 	}
 	return false;
@@ -1013,12 +980,12 @@ bool AccelAndGyro::getAccel(int16_t *aX, int16_t *aY, int16_t *aZ)
  */
 bool AccelAndGyro::getGyro(int16_t *gX, int16_t *gY, int16_t *gZ)
 {
-	int8_t gyro[6u];
-	if(readMultiBytes(MPU6050_GYRO_XOUT_H_REG,6u,(uint8_t *)gyro))
+	uint8_t gyro[6u];
+	if(readMultiBytes(MPU6050_GYRO_XOUT_H_REG,6u,gyro))
 	{
-		*gX = (gyro[0u] << 8)| gyro[1u];
-		*gY = (gyro[2u] << 8)| gyro[3u];
-		*gZ = (gyro[4u] << 8)| gyro[5u];
+		*gX = (int16_t)((gyro[0u] << 8)| gyro[1u]);
+		*gY = (int16_t)((gyro[2u] << 8)| gyro[3u]);
+		*gZ = (int16_t)((gyro[4u] << 8)| gyro[5u]);
 		return true;
 	}
 	return false;
@@ -1030,12 +997,12 @@ bool AccelAndGyro::getGyro(int16_t *gX, int16_t *gY, int16_t *gZ)
  */
 bool AccelAndGyro::getAccelOffset(int16_t *aX, int16_t *aY, int16_t *aZ)
 {
-	int8_t data[6u];
-	if(readMultiBytes(MPU6050_XA_OFFS_USRH_REG,6u,(uint8_t *)data))
+	uint8_t data[6u];
+	if(readMultiBytes(MPU6050_XA_OFFS_USRH_REG,6u,data))
 	{
-		*aX = (data[0u] << 8)| data[1u];
-		*aY = (data[2u] << 8)| data[3u];
-		*aZ = (data[4u] << 8)| data[5u];
+		*aX = (int16_t)((data[0u] << 8)| data[1u]);
+		*aY = (int16_t)((data[2u] << 8)| data[3u]);
+		*aZ = (int16_t)((data[4u] << 8)| data[5u]);
 		return true;
 	}
 	return false;
@@ -1066,12 +1033,12 @@ bool AccelAndGyro::setAccelOffset(int16_t *aX, int16_t *aY, int16_t *aZ)
  */
 bool AccelAndGyro::getGyroOffset(int16_t *gX, int16_t *gY, int16_t *gZ)
 {
-	int8_t data[6u];
-	if(readMultiBytes(MPU6050_XG_OFFS_USRH_REG,6u,(uint8_t *)data))
+	uint8_t data[6u];
+	if(readMultiBytes(MPU6050_XG_OFFS_USRH_REG,6u,data))
 	{
-		*gX = (data[0u] << 8)| data[1u];
-		*gY = (data[2u] << 8)| data[3u];
-		*gZ = (data[4u] << 8)| data[5u];
+		*gX = (int16_t)((data[0u] << 8)| data[1u]);
+		*gY = (int16_t)((data[2u] << 8)| data[3u]);
+		*gZ = (int16_t)((data[4u] << 8)| data[5u]);
 		return true;
 	}
 	return false;
@@ -1100,129 +1067,174 @@ bool AccelAndGyro::setGyroOffset(int16_t *gX, int16_t *gY, int16_t *gZ)
 /**
  *
  */
-float AccelAndGyro::getTempC(bool print)
+float AccelAndGyro::getTempC(void)
 {
-	int8_t data[2u];
+	uint8_t data[2u];
 	int16_t temp;
 	float tempC;
-	if(readMultiBytes(MPU6050_TEMP_OUT_H_REG,6u,(uint8_t *)data))
+	if(readMultiBytes(MPU6050_TEMP_OUT_H_REG,2u,data))
 	{
-		temp 	= (data[0u] << 8u) | data[1u] ;
+		temp 	= (int16_t)((data[0u] << 8)| data[1u]);
 		tempC 	= ((float)temp/340.f)+36.53f;
-		if(print)
-		{
-			Serial.print("Temperature (°C): ");
-		    Serial.print(tempC,2);
-		    Serial.println("°C");
-		}
+		MYOSA_LOGI("Temperature (°C): ", tempC, "°C");
 		return tempC;
 	}
-	return 0.f;
+	return NAN;
 }
 
 /**
  *
  */
-float AccelAndGyro::getTempF(bool print)
+float AccelAndGyro::getTempF(void)
 {
-	float tempF = (getTempC(false) * (9.f / 5.f)) + 32.f;
-	if(print)
-    {
-      Serial.print("Temperature (°F): ");
-      Serial.print(tempF,2);
-      Serial.println("°F");
-    }
+	float tempF = (getTempC() * (9.f / 5.f)) + 32.f;
+	MYOSA_LOGI("Temperature (°F): ", tempF, "°F");
 	return tempF;
 }
 
 /**
  *
  */
-float AccelAndGyro::getTiltX(bool print)
+float AccelAndGyro::getTiltX(void)
 {
 	float tiltX;
 	int16_t aX, aY, aZ;
 
-	getAccel(&aX,&aY,&aZ);
+	if(getAccel(&aX,&aY,&aZ) == false)
+	{
+		return NAN;
+	}
 	tiltX = (180.0/M_PI)*atan(aX/(sqrt(pow(aY,2)+pow(aZ,2))));
 
-	if(print)
-    {
-      Serial.print("Tilt Angle(X): ");
-      Serial.print(tiltX,2);
-      Serial.println("°");
-    }
+	MYOSA_LOGI("Tilt Angle(X): ", tiltX, "°");
 	return tiltX;
 }
 
 /**
  *
  */
-float AccelAndGyro::getTiltY(bool print)
+float AccelAndGyro::getTiltY(void)
 {
 	float tiltY;
 	int16_t aX, aY, aZ;
 
-	getAccel(&aX,&aY,&aZ);
+	if(getAccel(&aX,&aY,&aZ) == false)
+	{
+		return NAN;
+	}
 	tiltY = (180.0/M_PI)*atan(aY/(sqrt(pow(aX,2)+pow(aZ,2))));
 
-	if(print)
-    {
-      Serial.print("Tilt Angle(Y): ");
-      Serial.print(tiltY,2);
-      Serial.println("°");
-    }
+	MYOSA_LOGI("Tilt Angle(Y): ", tiltY, "°");
 	return tiltY;
 }
 
 /**
  *
  */
-float AccelAndGyro::getTiltZ(bool print)
+float AccelAndGyro::getTiltZ(void)
 {
 	float tiltZ;
 	int16_t aX, aY, aZ;
 
-	getAccel(&aX,&aY,&aZ);
+	if(getAccel(&aX,&aY,&aZ) == false)
+	{
+		return NAN;
+	}
 	tiltZ = (180.0/M_PI)*atan((sqrt(pow(aX,2)+pow(aY,2))/aZ));
 
-	if(print)
-    {
-      Serial.print("Tilt Angle(Z): ");
-      Serial.print(tiltZ,2);
-      Serial.println("°");
-    }
+	MYOSA_LOGI("Tilt Angle(Z): ", tiltZ, "°");
 	return tiltZ;
 }
 
 /**
  *
  */
-bool AccelAndGyro::getMotionStatus(bool print)
+bool AccelAndGyro::getMotionStatus(void)
 {
 	bool motionSts = getIntMotionStatus();
-	Serial.print("Motion Detection Status: ");
-	if(motionSts)
+	MYOSA_LOGI("Motion Detection Status: ", motionSts ? "True" : "False");
+	return motionSts;
+}
+
+/**
+ * Reads accel, temperature and gyro in one 14 byte burst so all axes come
+ * from the same sampling instant. Uses the full-scale ranges cached by
+ * setFullScale*Range() instead of re-reading the config registers.
+ */
+bool AccelAndGyro::getSample(mpu6050Sample_t *sample)
+{
+	int16_t raw[MPU6050_SAMPLE_WORDS];
+	if(readRawSample(raw) == false)
 	{
-		 Serial.println("True");
+		return false;
 	}
-	else
+	convertSample(raw, sample);
+	return true;
+}
+
+/**
+ * Bus part of getSample(): the 14 byte burst, byte swapped into words
+ */
+bool AccelAndGyro::readRawSample(int16_t raw[MPU6050_SAMPLE_WORDS])
+{
+	uint8_t data[MPU6050_SAMPLE_BYTES];
+	if(readMultiBytes(MPU6050_ACCEL_XOUT_H_REG,MPU6050_SAMPLE_BYTES,data) == false)
 	{
-		Serial.println("False");
+		return false;
 	}
-	return motionSts;
+	unpackSample(data,raw);
+	return true;
+}
+
+/**
+ * Byte swaps a 14 byte burst from ACCEL_XOUT_H into words, for bursts
+ * read outside the driver (e.g. queued on a bus task)
+ */
+void AccelAndGyro::unpackSample(const uint8_t data[MPU6050_SAMPLE_BYTES], int16_t raw[MPU6050_SAMPLE_WORDS])
+{
+	for(uint8_t n = 0u; n < MPU6050_SAMPLE_WORDS; n++)
+	{
+		raw[n] = (int16_t)((data[2u*n] << 8) | data[2u*n + 1u]);
+	}
+}
+
+/**
+ *
+ */
+uint8_t AccelAndGyro::getI2CAddress(void)
+{
+	return _i2cSlaveAddress;
+}
+
+/**
+ * CPU part of getSample(): scaling and tilt angles, no bus access
+ */
+void AccelAndGyro::convertSample(const int16_t raw[MPU6050_SAMPLE_WORDS], mpu6050Sample_t *sample)
+{
+	float fX = (float)raw[0u], fY = (float)raw[1u], fZ = (float)raw[2u];
+
+	sample->accelX = fX * _accelScale[_accelFsr] * 100.f;
+	sample->accelY = fY * _accelScale[_accelFsr] * 100.f;
+	sample->accelZ = fZ * _accelScale[_accelFsr] * 100.f;
+	sample->tempC  = ((float)raw[3u]/340.f)+36.53f;
+	sample->gyroX  = (float)raw[4u] * _gyroScale[_gyroFsr];
+	sample->gyroY  = (float)raw[5u] * _gyroScale[_gyroFsr];
+	sample->gyroZ  = (float)raw[6u] * _gyroScale[_gyroFsr];
+
+	sample->tiltX = (180.f/(float)M_PI)*atanf(fX/sqrtf(fY*fY + fZ*fZ));
+	sample->tiltY = (180.f/(float)M_PI)*atanf(fY/sqrtf(fX*fX + fZ*fZ));
+	sample->tiltZ = (180.f/(float)M_PI)*atanf(sqrtf(fX*fX + fY*fY)/fZ);
 }
 
 /***********************************************************************************************
  * Platform dependent routines. Change these functions implementation based on microcontroller *
  ***********************************************************************************************/
 /**
- *
+ *   @brief attach to the shared bus, which starts with the first transaction
  */
 void AccelAndGyro::i2c_init(void)
 {
-	Wire.begin();
-	Wire.setClock(100000);
+	_bus = I2cBus::shared().attach(_i2cSlaveAddress, MPU6050_I2C_MAX_HZ, "mpu6050");
 }
 
 /**
@@ -1230,43 +1242,23 @@ void AccelAndGyro::i2c_init(void)
  */
 bool AccelAndGyro::readByte(uint8_t reg, uint8_t *in)
 {
-	Wire.beginTransmission((uint8_t)_i2cSlaveAddress);
-	Wire.write(reg);
-	if(Wire.endTransmission(true) != 0)
+	if(I2cBus::shared().read(_bus, reg, in, 1u) != I2C_RESULT_OK)
 	{
 		return false;
 	}
-	Wire.requestFrom((uint8_t)_i2cSlaveAddress, (uint8_t)1u, (uint8_t)1u);
-	if(Wire.available() != 1u)
-	{
-		return false;
-	}
-	*in = Wire.read();
 	return true;
- }
+}
 
 /**
  *
  */
 bool AccelAndGyro::readMultiBytes(uint8_t reg, uint8_t length, uint8_t *in)
 {
-  Wire.beginTransmission((uint8_t)_i2cSlaveAddress);
-   Wire.write(reg);
-   if(Wire.endTransmission(true) != 0)
-   {
-     return false;
-   }
-   Wire.requestFrom((uint8_t)_i2cSlaveAddress, (uint8_t)length, (uint8_t)1u);
-   if(Wire.available() != length)
-   {
-     return false;
-   }
-   uint8_t nData;
-   for(nData = 0u; nData < length; nData++)
-   {
-     in[nData] = Wire.read();
-   }
-   return true;
+	if(I2cBus::shared().read(_bus, reg, in, length) != I2C_RESULT_OK)
+	{
+		return false;
+	}
+	return true;
 }
 
 /**
@@ -1274,13 +1266,11 @@ bool AccelAndGyro::readMultiBytes(uint8_t reg, uint8_t length, uint8_t *in)
  */
 bool AccelAndGyro::writeByte(uint8_t reg)
 {
-   Wire.beginTransmission((uint8_t)_i2cSlaveAddress);
-   Wire.write(reg);
-   if (Wire.endTransmission(true) == 0)
-   {
-     return true;
-   }
-   return false;
+	if(I2cBus::shared().write(_bus, reg, NULL, 0u) != I2C_RESULT_OK)
+	{
+		return false;
+	}
+	return true;
 }
 
 /**
@@ -1288,14 +1278,19 @@ bool AccelAndGyro::writeByte(uint8_t reg)
  */
 bool AccelAndGyro::writeByte(uint8_t reg, uint8_t val)
 {
-   Wire.beginTransmission((uint8_t)_i2cSlaveAddress);
-   Wire.write(reg);
-   Wire.write(val);
-   if (Wire.endTransmission(true) == 0)
-   {
-     return true;
-   }
-   return false;
+	if(I2cBus::shared().write(_bus, reg, &val, 1u) != I2C_RESULT_OK)
+	{
+		return false;
+	}
+	return true;
+}
+
+/**
+ *
+ */
+bool AccelAndGyro::writeMultiBytes(uint8_t reg, uint8_t length, const uint8_t *in)
+{
+	return I2cBus::shared().write(_bus, reg, in, length) == I2C_RESULT_OK;
 }
 
 /**
@@ -1303,27 +1298,23 @@ bool AccelAndGyro::writeByte(uint8_t reg, uint8_t val)
  */
 bool AccelAndGyro::writeAddress(void)
 {
-   Wire.beginTransmission((uint8_t)_i2cSlaveAddress);
-   if (Wire.endTransmission(true) == 0)
-   {
-     return true;
-   }
-   return false;
+	return I2cBus::shared().probe(_bus);
 }
 
 /**
  *
  */
-bool AccelAndGyro::writeMultiBytes(uint8_t reg, uint8_t length, const uint8_t *in)
+bool AccelAndGyro::writeTable(const i2cRegValue_t *table, uint8_t count)
+{
+	return I2cBus::shared().writeTable(_bus, table, count) == I2C_RESULT_OK;
+}
+
+/**
+ *
+ */
+I2cResult AccelAndGyro::busResult(void) const
 {
-  Wire.beginTransmission((uint8_t)_i2cSlaveAddress);
-  Wire.write(reg);
-  Wire.write(in,length);
-  if (Wire.endTransmission(true) == 0)
-  {
-    return true;
-  }
-  return false;
+	return I2cBus::shared().lastResult(_bus);
 }
 
 /**
@@ -31,9 +31,12 @@
 #include <math.h>
 #include <Arduino.h>
 #include <Wire.h>
+#include <MyosaLog.h>
+#include <I2cBus.h>
 
 #define MPU6050_ADDRESS_AD0_LOW             0x68u
 #define MPU6050_ADDRESS_AD0_HIGH            0x69u
+#define MPU6050_I2C_MAX_HZ                  400000u   /**< fast mode */
 
 #define MPU6050_XA_OFFS_USRH_REG            0x06u
 #define MPU6050_XA_OFFS_USRL_REG            0x07u
@@ -170,6 +173,25 @@
 
 #define MPU_WHO_AM_I_MSK                    0x7Eu
 #define CALIBRATION_READINGS                50u
+#define MPU6050_SAMPLE_BYTES                14u   /* ACCEL_XOUT_H .. GYRO_ZOUT_L */
+#define MPU6050_SAMPLE_WORDS                7u    /* aX aY aZ temp gX gY gZ */
+
+/*!
+ * One coherent accelerometer/temperature/gyroscope sample taken in a single burst read
+ */
+typedef struct
+{
+  float accelX;   /**< cm/s^2 */
+  float accelY;
+  float accelZ;
+  float tempC;
+  float gyroX;    /**< deg/s */
+  float gyroY;
+  float gyroZ;
+  float tiltX;    /**< deg */
+  float tiltY;
+  float tiltZ;
+}mpu6050Sample_t;
 
 class AccelAndGyro
 {
@@ -178,6 +200,8 @@ class AccelAndGyro
       bool begin(bool calibrate=false);
       bool accelGyroCalibrate(void);
       bool ping(void);
+      /* outcome of the last bus transaction, the reason when a call above failed */
+      I2cResult busResult(void) const;
       uint8_t getDeviceId(void);
       bool reset(void);
       bool resetGyroPath(void);
@@ -224,22 +248,31 @@ class AccelAndGyro
       bool setIntZeroMotionEnabled(bool enable);
       bool getIntZeroMotionStatus(void);
 
-      float getAccelX(bool print=true);
-      float getAccelY(bool print=true);
-      float getAccelZ(bool print=true);
-      float getGyroX(bool print=true);
-      float getGyroY(bool print=true);
-      float getGyroZ(bool print=true);
-      float getTempC(bool print=true);
-      float getTempF(bool print=true);
-      float getTiltX(bool print=true);
-      float getTiltY(bool print=true);
-      float getTiltZ(bool print=true);
-      bool getMotionStatus(bool print=true);
+      /* NAN when the bus transaction failed */
+      float getAccelX(void);
+      float getAccelY(void);
+      float getAccelZ(void);
+      float getGyroX(void);
+      float getGyroY(void);
+      float getGyroZ(void);
+      float getTempC(void);
+      float getTempF(void);
+      float getTiltX(void);
+      float getTiltY(void);
+      float getTiltZ(void);
+      bool getMotionStatus(void);
+      bool getSample(mpu6050Sample_t *sample);
+      bool readRawSample(int16_t raw[MPU6050_SAMPLE_WORDS]);
+      void convertSample(const int16_t raw[MPU6050_SAMPLE_WORDS], mpu6050Sample_t *sample);
+      static void unpackSample(const uint8_t data[MPU6050_SAMPLE_BYTES], int16_t raw[MPU6050_SAMPLE_WORDS]);
+      uint8_t getI2CAddress(void);
   private:
       float _accelScale[4u];
       float _gyroScale[4u];
+      uint8_t _accelFsr;
+      uint8_t _gyroFsr;
       uint8_t _i2cSlaveAddress;
+      int8_t _bus;                /**< I2cBus handle */
       bool _isConnected;
       bool getAccel(int16_t *aX, int16_t *aY, int16_t *aZ);
       bool getGyro(int16_t *gX, int16_t *gY, int16_t *gZ);
@@ -254,6 +287,7 @@ class AccelAndGyro
       bool writeByte(uint8_t reg, uint8_t val);
       bool writeAddress(void);
       bool writeMultiBytes(uint8_t reg, uint8_t length, const uint8_t *in);
+      bool writeTable(const i2cRegValue_t *table, uint8_t count);
       void delay_ms(uint16_t ms);
 };
 
@@ -34,6 +34,7 @@ AirQuality::AirQuality(uint8_t i2c_add, float refRes)
   _i2cSlaveAddress = 0x5Au;
   _refResistance   = refRes;
   _isConnected     = false;
+  i2c_init();
 }
 
 /**
@@ -321,28 +322,18 @@ CCS811_STATUS_t AirQuality::getErrorIdReg(CCS811_ERROR_ID_REG_t *errorId)
 /*
  *
  */
-uint16_t AirQuality::getTVOC(bool print)
+uint16_t AirQuality::getTVOC(void)
 {
-  if(print)
-  {
-    Serial.print("TVOC: ");
-    Serial.print(_tVOC);
-    Serial.println("ppb");
-  }
+  MYOSA_LOGI("TVOC: ", _tVOC, "ppb");
   return _tVOC;
 }
 
 /*
  *
  */
-uint16_t AirQuality::getCO2(bool print)
+uint16_t AirQuality::getCO2(void)
 {
-  if(print)
-  {
-    Serial.print("eCO2: ");
-    Serial.print(_CO2);
-    Serial.println("ppm");
-  }
+  MYOSA_LOGI("eCO2: ", _CO2, "ppm");
   return _CO2;
 }
 
@@ -437,12 +428,11 @@ char * AirQuality::getFwAppVersion(void)
  * Platform dependent routines. Change these functions implementation based on microcontroller *
  ***********************************************************************************************/
 /**
- *
+ *   @brief attach to the shared bus, which starts with the first transaction
  */
 void AirQuality::i2c_init(void)
 {
-  Wire.begin();
-  Wire.setClock(100000);
+  _bus = I2cBus::shared().attach(_i2cSlaveAddress, CCS811_I2C_MAX_HZ, "ccs811");
 }
 
 /**
@@ -450,18 +440,10 @@ void AirQuality::i2c_init(void)
  */
 CCS811_STATUS_t AirQuality::readByte(uint8_t reg, uint8_t *in)
 {
-  Wire.beginTransmission((uint8_t)_i2cSlaveAddress);
-  Wire.write(reg);
-  if(Wire.endTransmission(true) != 0)
-  {
-   return SENSOR_I2C_ERROR;
-  }
-  Wire.requestFrom((uint8_t)_i2cSlaveAddress, (uint8_t)1u, (uint8_t)1u);
-  if(Wire.available() != 1u)
+  if(I2cBus::shared().read(_bus, reg, in, 1u) != I2C_RESULT_OK)
   {
-   return SENSOR_I2C_ERROR;
+    return SENSOR_I2C_ERROR;
   }
-  *in = Wire.read();
   return SENSOR_SUCCESS;
 }
 
@@ -470,22 +452,10 @@ CCS811_STATUS_t AirQuality::readByte(uint8_t reg, uint8_t *in)
  */
 CCS811_STATUS_t AirQuality::readMultiBytes(uint8_t reg, uint8_t length, uint8_t *in)
 {
-  Wire.beginTransmission((uint8_t)_i2cSlaveAddress);
-  Wire.write(reg);
-  if(Wire.endTransmission(true) != 0)
-  {
-    return SENSOR_I2C_ERROR;
-  }
-  Wire.requestFrom((uint8_t)_i2cSlaveAddress, (uint8_t)length, (uint8_t)1u);
-  if(Wire.available() != length)
+  if(I2cBus::shared().read(_bus, reg, in, length) != I2C_RESULT_OK)
   {
     return SENSOR_I2C_ERROR;
   }
-  uint8_t nData;
-  for(nData = 0u; nData < length; nData++)
-  {
-    in[nData] = Wire.read();
-  }
   return SENSOR_SUCCESS;
 }
 
@@ -494,13 +464,11 @@ CCS811_STATUS_t AirQuality::readMultiBytes(uint8_t reg, uint8_t length, uint8_t
  */
 CCS811_STATUS_t AirQuality::writeByte(uint8_t reg)
 {
-  Wire.beginTransmission((uint8_t)_i2cSlaveAddress);
-  Wire.write(reg);
-  if (Wire.endTransmission(true) == 0)
+  if(I2cBus::shared().write(_bus, reg, NULL, 0u) != I2C_RESULT_OK)
   {
-    return SENSOR_SUCCESS;
+    return SENSOR_I2C_ERROR;
   }
-  return SENSOR_I2C_ERROR;
+  return SENSOR_SUCCESS;
 }
 
 /**
@@ -508,14 +476,11 @@ CCS811_STATUS_t AirQuality::writeByte(uint8_t reg)
  */
 CCS811_STATUS_t AirQuality::writeByte(uint8_t reg, uint8_t val)
 {
-  Wire.beginTransmission((uint8_t)_i2cSlaveAddress);
-  Wire.write(reg);
-  Wire.write(val);
-  if (Wire.endTransmission(true) == 0)
+  if(I2cBus::shared().write(_bus, reg, &val, 1u) != I2C_RESULT_OK)
   {
-    return SENSOR_SUCCESS;
+    return SENSOR_I2C_ERROR;
   }
-  return SENSOR_I2C_ERROR;
+  return SENSOR_SUCCESS;
 }
 
 /**
@@ -523,14 +488,11 @@ CCS811_STATUS_t AirQuality::writeByte(uint8_t reg, uint8_t val)
  */
 CCS811_STATUS_t AirQuality::writeMultiBytes(uint8_t reg, uint8_t length, const uint8_t *out)
 {
-  Wire.beginTransmission((uint8_t)_i2cSlaveAddress);
-  Wire.write(reg);
-  Wire.write(out,length);
-  if (Wire.endTransmission(true) == 0)
+  if(I2cBus::shared().write(_bus, reg, out, length) != I2C_RESULT_OK)
   {
-    return SENSOR_SUCCESS;
+    return SENSOR_I2C_ERROR;
   }
-  return SENSOR_I2C_ERROR;
+  return SENSOR_SUCCESS;
 }
 
 /**
@@ -538,12 +500,15 @@ CCS811_STATUS_t AirQuality::writeMultiBytes(uint8_t reg, uint8_t length, const u
  */
 bool AirQuality::writeAddress(void)
 {
-  Wire.beginTransmission((uint8_t)_i2cSlaveAddress);
-  if (Wire.endTransmission(true) == 0)
-  {
-    return true;
-  }
-  return false;
+  return I2cBus::shared().probe(_bus);
+}
+
+/**
+ *
+ */
+I2cResult AirQuality::busResult(void) const
+{
+  return I2cBus::shared().lastResult(_bus);
 }
 
 /**
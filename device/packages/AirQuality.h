@@ -32,10 +32,13 @@
 #include <math.h>
 #include <Arduino.h>
 #include <Wire.h>
+#include <MyosaLog.h>
+#include <I2cBus.h>
 
 #define CCS811_HW_ID                0x81u
 #define CCS811_I2C_ADDRESS0         0x5Au
 #define CCS811_I2C_ADDRESS1         0x5Bu
+#define CCS811_I2C_MAX_HZ           400000u   /**< fast mode, with clock stretching */
 
 /* Defining constant used in the calculation. Depends on hardware. Don't change. */
 const float refResitance = 10000.f;
@@ -126,9 +129,11 @@ class AirQuality
     CCS811_STATUS_t begin(void);
     CCS811_STATUS_t reset(void);
     bool ping(void);
+    /* outcome of the last bus transaction, the reason when a call above failed */
+    I2cResult busResult(void) const;
     CCS811_STATUS_t readAlgorithmResults(void);
-    uint16_t getTVOC(bool print=true);
-    uint16_t getCO2(bool print=true);
+    uint16_t getTVOC(void);
+    uint16_t getCO2(void);
     float getResistance(void);
     float getTemperature(void);
     uint8_t getHwId(void);
@@ -161,6 +166,7 @@ class AirQuality
     CCS811_MEAS_MODE_REG_t measModeReg;
     CCS811_STATUS_REG_t statusReg;
     uint8_t _i2cSlaveAddress;
+    int8_t _bus;                  /**< I2cBus handle */
     bool _isConnected;
     char _versionInfo[10u];
     void i2c_init(void);
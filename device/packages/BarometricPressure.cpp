@@ -34,6 +34,7 @@ BarometricPressure::BarometricPressure(bmp180AccuracyMode_t accr){
   _accuracy = accr;
   _i2cSlaveAddress = BMP180_I2C_ADDRESS;
   _isConnected = false;
+  i2c_init();
 }
 
 /**
@@ -82,45 +83,43 @@ float BarometricPressure::getTemperature(void){
   {
     return BMP180_ERROR;
   }
-  float temperature = ((computeB5(UT) + 8) >> 4)/10.f;
-  return temperature;
+  return computeTemperature(UT);
+}
+
+/**
+ *
+ */
+float BarometricPressure::computeTemperature(int32_t UT)
+{
+  return ((computeB5(UT) + 8) >> 4)/10.f;
 }
 
 /**
  *
  */
-float BarometricPressure::getTempC(bool print)
+float BarometricPressure::getTempC(void)
 {
   float temperature = getTemperature();
   if(temperature == BMP180_ERROR)
   {
-    temperature = 0.f;
-  }
-  if(print)
-  {
-    Serial.print("Temperature (°C): ");
-    Serial.print(temperature,2);
-    Serial.println("°C");
+    return NAN;
   }
+  MYOSA_LOGI("Temperature (°C): ", temperature, "°C");
   return temperature;
 }
 
 /**
  *
  */
-float BarometricPressure::getTempF(bool print)
+float BarometricPressure::getTempF(void)
 {
-  float temperature = (getTemperature() * (9.f/5.f)) + 32.f;
+  float temperature = getTemperature();
   if(temperature == BMP180_ERROR)
   {
-    temperature = 0.f;
-  }
-  if(print)
-  {
-    Serial.print("Temperature (°F): ");
-    Serial.print(temperature,2);
-    Serial.println("°F");
+    return NAN;
   }
+  temperature = (temperature * (9.f/5.f)) + 32.f;
+  MYOSA_LOGI("Temperature (°F): ", temperature, "°F");
   return temperature;
 }
 
@@ -131,6 +130,21 @@ float BarometricPressure::getTempF(bool print)
  {
    int32_t  UT       = 0;
    int32_t  UP       = 0;
+
+   UT = readRawTemperature();                           //read uncompensated temperature, 16-bit
+   if (UT == BMP180_ERROR) return BMP180_ERROR;         //error handler, collision on i2c bus
+
+   UP = readRawPressure();                              //read uncompensated pressure, 19-bit
+   if (UP == BMP180_ERROR) return BMP180_ERROR;         //error handler, collision on i2c bus
+
+   return computePressure(UT, UP);
+ }
+
+/**
+ *
+ */
+int32_t BarometricPressure::computePressure(int32_t UT, int32_t UP)
+{
    int32_t  B3       = 0;
    int32_t  B5       = 0;
    int32_t  B6       = 0;
@@ -141,12 +155,6 @@ float BarometricPressure::getTempF(bool print)
    uint32_t B4       = 0;
    uint32_t B7       = 0;
 
-   UT = readRawTemperature();                           //read uncompensated temperature, 16-bit
-   if (UT == BMP180_ERROR) return BMP180_ERROR;         //error handler, collision on i2c bus
-
-   UP = readRawPressure();                              //read uncompensated pressure, 19-bit
-   if (UP == BMP180_ERROR) return BMP180_ERROR;         //error handler, collision on i2c bus
-
    B5 = computeB5(UT);
 
    /* pressure calculation */
@@ -172,96 +180,71 @@ float BarometricPressure::getTempF(bool print)
    X2 = (-7357L * pressure) >> 16;
 
    return pressure = pressure + ((X1 + X2 + 3791L) >> 4);
- }
+}
 
 /**
  *
  */
-float BarometricPressure::getPressurePascal(bool print)
+float BarometricPressure::getPressurePascal(void)
 {
   float pressurePascal = getPressure();
   if(pressurePascal == BMP180_ERROR)
   {
-    pressurePascal = 0.f;
-  }
-  if(print)
-  {
-    Serial.print("Pressure (kilo-pascal): ");
-    Serial.print((pressurePascal/1000.f),2);
-    Serial.println("kilo-pascal");
+    return NAN;
   }
+  MYOSA_LOGI("Pressure (kilo-pascal): ", pressurePascal/1000.f, "kilo-pascal");
   return pressurePascal/1000.f;
 }
 
 /**
  *
  */
-float BarometricPressure::getPressureHg(bool print)
+float BarometricPressure::getPressureHg(void)
 {
   float pressurePascal = getPressure();
   if(pressurePascal == BMP180_ERROR)
   {
-    pressurePascal = 0.f;
-  }
-  if(print)
-  {
-    Serial.print("Pressure (mmHg): ");
-    Serial.print((pressurePascal/133.f),2);
-    Serial.println("mmHg");
+    return NAN;
   }
+  MYOSA_LOGI("Pressure (mmHg): ", pressurePascal/133.f, "mmHg");
   return pressurePascal/133.f;
 }
 
 /**
  *
  */
-float BarometricPressure::getPressureBar(bool print)
+float BarometricPressure::getPressureBar(void)
 {
   float pressurePascal = getPressure();
   if(pressurePascal == BMP180_ERROR)
   {
-    pressurePascal = 0.f;
-  }
-  if(print)
-  {
-    Serial.print("Pressure (mbar): ");
-    Serial.print((pressurePascal/100.f),2);
-    Serial.println("mbar");
+    return NAN;
   }
+  MYOSA_LOGI("Pressure (mbar): ", pressurePascal/100.f, "mbar");
   return pressurePascal/100.f;
 }
 
 /**
  *
  */
-float BarometricPressure::getSeaLevelPressure(float altitude, bool print)
+float BarometricPressure::getSeaLevelPressure(float altitude)
 {
     float slp;
-    float pressure = getPressureBar(false);
+    float pressure = getPressureBar();
     slp = pressure / pow(1.0 - altitude/44330.0 , 5.255);
-    if(print)
-    {
-        Serial.print("Sea Level Pressure: ");
-        Serial.print(slp,2);
-        Serial.println("mbar");
-    }
+    MYOSA_LOGI("Sea Level Pressure: ", slp, "mbar");
     return slp;
 }
 
 /**
  *
  */
-float BarometricPressure::getAltitude(float p0, bool print)
+float BarometricPressure::getAltitude(float p0)
 {
     float altitude;
-    float pressure = getPressureBar(false);
+    float pressure = getPressureBar();
     altitude = 44330.0 * (1.0 - pow((pressure/p0),(1.0/5.255)));
-    if(print)
-    {
-        Serial.print("Altitude: ");
-        Serial.print(altitude,2);
-        Serial.println("meters");
-    }
+    MYOSA_LOGI("Altitude: ", altitude, "meters");
     return altitude;
 }
 
@@ -382,16 +365,75 @@ uint32_t BarometricPressure::readRawPressure(void)
   return rawPressure;
 }
 
+/**
+ *   @brief kick off a temperature conversion without waiting for it
+ */
+bool BarometricPressure::startTemperature(void)
+{
+  return write8bit(CONTROL_REG,BMP180_GET_TEMPERATURE);
+}
+
+/**
+ *   @brief kick off a pressure conversion at the configured oversampling
+ */
+bool BarometricPressure::startPressure(void)
+{
+  const uint8_t cmd[4u] = {BMP180_GET_PRESSURE_OSS0, BMP180_GET_PRESSURE_OSS1,
+                           BMP180_GET_PRESSURE_OSS2, BMP180_GET_PRESSURE_OSS3};
+  return write8bit(CONTROL_REG,cmd[_accuracy & 0x03u]);
+}
+
+/**
+ *   @brief true once the running conversion has finished (SCO cleared)
+ */
+bool BarometricPressure::isConversionDone(void)
+{
+  uint8_t ctrl = read8bit(CONTROL_REG);
+  if(ctrl == BMP180_ERROR)
+  {
+    return false;
+  }
+  return (ctrl & BMP180_CTRL_SCO_MSK) == 0u;
+}
+
+/**
+ *
+ */
+bool BarometricPressure::readRawTemperatureResult(int32_t *UT)
+{
+  uint16_t raw = read16bit(ADC_OUT_MSB_REG);
+  if(raw == BMP180_ERROR)
+  {
+    return false;
+  }
+  *UT = raw;
+  return true;
+}
+
+/**
+ *
+ */
+bool BarometricPressure::readRawPressureResult(int32_t *UP)
+{
+  uint8_t data[3u];
+  /* MSB, LSB and XLSB in one burst so they belong to the same conversion */
+  if(readMultiBytes(ADC_OUT_MSB_REG,3u,data) == false)
+  {
+    return false;
+  }
+  *UP = (((uint32_t)data[0u] << 16) | ((uint32_t)data[1u] << 8) | data[2u]) >> (8u - _accuracy);
+  return true;
+}
+
 /***********************************************************************************************
  * Platform dependent routines. Change these functions implementation based on microcontroller *
  ***********************************************************************************************/
 /**
- *
+ *   @brief attach to the shared bus, which starts with the first transaction
  */
 void BarometricPressure::i2c_init(void)
 {
-  Wire.begin();
-  Wire.setClock(100000);
+  _bus = I2cBus::shared().attach(_i2cSlaveAddress, BMP180_I2C_MAX_HZ, "bmp180");
 }
 
 /**
@@ -399,18 +441,12 @@ void BarometricPressure::i2c_init(void)
  */
 uint8_t BarometricPressure::read8bit(bmp180Reg_t reg)
 {
-  Wire.beginTransmission(_i2cSlaveAddress);
-  Wire.write(reg);
-  if(Wire.endTransmission(true) != 0)
-  {
-    return BMP180_ERROR;
-  }
-  Wire.requestFrom(_i2cSlaveAddress, (uint8_t)1u, (uint8_t)1u);
-  if(Wire.available() != 1u)
+  uint8_t value;
+  if(I2cBus::shared().read(_bus, reg, &value, 1u) != I2C_RESULT_OK)
   {
     return BMP180_ERROR;
   }
-  return Wire.read();
+  return value;
 }
 
 /**
@@ -418,21 +454,20 @@ uint8_t BarometricPressure::read8bit(bmp180Reg_t reg)
  */
 uint16_t BarometricPressure::read16bit(bmp180Reg_t reg)
 {
-  uint16_t value=0u;
-  Wire.beginTransmission(_i2cSlaveAddress);
-  Wire.write(reg);
-  if(Wire.endTransmission(true) != 0)
+  uint8_t data[2u];
+  if(I2cBus::shared().read(_bus, reg, data, 2u) != I2C_RESULT_OK)
   {
     return BMP180_ERROR;
   }
-  Wire.requestFrom(_i2cSlaveAddress, (uint8_t)2u, (uint8_t)1u);
-  if(Wire.available() != 2u)
-  {
-    return BMP180_ERROR;
-  }
-  value  = Wire.read() << 8;
-  value |= Wire.read();
-  return value;
+  return ((uint16_t)data[0u] << 8) | data[1u];
+}
+
+/**
+ *
+ */
+bool BarometricPressure::readMultiBytes(bmp180Reg_t reg, uint8_t length, uint8_t *in)
+{
+  return I2cBus::shared().read(_bus, reg, in, length) == I2C_RESULT_OK;
 }
 
 /**
@@ -440,14 +475,7 @@ uint16_t BarometricPressure::read16bit(bmp180Reg_t reg)
  */
 bool BarometricPressure::write8bit(bmp180Reg_t reg, uint8_t val)
 {
-  Wire.beginTransmission(_i2cSlaveAddress);
-  Wire.write(reg);
-  Wire.write(val);
-  if (Wire.endTransmission(true) == 0)
-  {
-    return true;
-  }
-  return false;
+  return I2cBus::shared().write(_bus, reg, &val, 1u) == I2C_RESULT_OK;
 }
 
 /**
@@ -455,12 +483,15 @@ bool BarometricPressure::write8bit(bmp180Reg_t reg, uint8_t val)
  */
 bool BarometricPressure::writeAddress(void)
 {
-  Wire.beginTransmission((uint8_t)_i2cSlaveAddress);
-  if (Wire.endTransmission(true) == 0)
-  {
-    return true;
-  }
-  return false;
+  return I2cBus::shared().probe(_bus);
+}
+
+/**
+ *
+ */
+I2cResult BarometricPressure::busResult(void) const
+{
+  return I2cBus::shared().lastResult(_bus);
 }
 
 /**
@@ -32,6 +32,8 @@
 #include <math.h>
 #include <Arduino.h>
 #include <Wire.h>
+#include <MyosaLog.h>
+#include <I2cBus.h>
 
 #define BMP180_SOFT_REST_VALUE    0xB6u   /**< write this value in SOFT_RESET_REG to soft reset the BMP180 */
 #define BMP180_GET_TEMPERATURE    0x2Eu   /**< write this value in CONTROL_REG to get the temperature */
@@ -40,9 +42,11 @@
 #define BMP180_GET_PRESSURE_OSS2  0xB4u   /**< write this value in CONTROL_REG to get the pressure with oversampling 2 */
 #define BMP180_GET_PRESSURE_OSS3  0xF4u   /**< write this value in CONTROL_REG to get the pressure with oversampling 3 */
 #define BMP180_I2C_ADDRESS        0x77u   /**< I2C slave address */
+#define BMP180_I2C_MAX_HZ         400000u /**< fast mode (high speed is not used) */
 #define BMP180_CHIP_ID            0x55u   /**< BMP180 Chip ID */
 #define BMP180_ERROR              255
 #define BMP180_MAX_COEFF_REGS     11u     /* number of coefficient registers in BMP180 */
+#define BMP180_CTRL_SCO_MSK       0x20u   /**< Start of conversion bit, stays set while a conversion runs */
 
 #define SEA_LEVEL_AVG_PRESSURE    1013.25   /* Average sea-level pressure is 1013.25 mbar */
 
@@ -105,19 +109,31 @@ class BarometricPressure
     BarometricPressure(bmp180AccuracyMode_t=ULTRA_LOW_POWER);
     bool begin(void);
     int32_t getPressure(void);
-    float getPressurePascal(bool print=true);
-    float getPressureHg(bool print=true);
-    float getPressureBar(bool print=true);
-    float getTempC(bool print=true);
-    float getTempF(bool print=true);
-    float getAltitude(float p0, bool print=true);
-    float getSeaLevelPressure(float altitude, bool print=true);
+    /* NAN when the bus transaction failed */
+    float getPressurePascal(void);
+    float getPressureHg(void);
+    float getPressureBar(void);
+    float getTempC(void);
+    float getTempF(void);
+    float getAltitude(float p0);
+    float getSeaLevelPressure(float altitude);
     void reset(void);
     bool ping(void);
+    /* outcome of the last bus transaction, the reason when a call above failed */
+    I2cResult busResult(void) const;
     uint8_t getDeviceId(void);
     void setAccuracyMode(bmp180AccuracyMode_t mode);
+    /* Non-blocking conversion: start, poll isConversionDone(), then collect */
+    bool startTemperature(void);
+    bool startPressure(void);
+    bool isConversionDone(void);
+    bool readRawTemperatureResult(int32_t *UT);
+    bool readRawPressureResult(int32_t *UP);
+    float computeTemperature(int32_t UT);
+    int32_t computePressure(int32_t UT, int32_t UP);
   private:
     uint8_t _i2cSlaveAddress;
+    int8_t _bus;                  /**< I2cBus handle */
     bool _isConnected;
     uint8_t  _accuracy;
     bmp180CalibCoeff_t _calibCoeff;
@@ -129,6 +145,7 @@ class BarometricPressure
     void i2c_init(void);
     uint8_t  read8bit(bmp180Reg_t reg);
     uint16_t read16bit(bmp180Reg_t reg);
+    bool readMultiBytes(bmp180Reg_t reg, uint8_t length, uint8_t *in);
     bool write8bit(bmp180Reg_t reg, uint8_t val);
     bool writeAddress(void);
     void delay_ms(uint16_t ms);
@@ -0,0 +1,454 @@
+/*
+  This code is developed under the MYOSA (LearnTheEasyWay) initiative of MakeSense EduTech and Pegasus Automation.
+
+  NOTE
+  Unless required by applicable law or agreed to in writing, this software is distributed on an
+  "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied
+*/
+
+#include "I2cBus.h"
+#include <string.h>
+
+/**
+ *   @brief function local, so drivers constructed as globals in other units find it ready
+ */
+I2cBus &I2cBus::shared(void)
+{
+  static I2cBus bus;
+  return bus;
+}
+
+/**
+ *
+ */
+I2cBus::I2cBus()
+{
+  _mutex      = NULL;
+  _begun      = false;
+  _clockHz    = I2C_STANDARD_MODE_HZ;
+  _count      = 0u;
+  _recoveries = 0u;
+  _stuck      = false;
+  memset(_dev, 0, sizeof(_dev));
+}
+
+/**
+ *
+ */
+bool I2cBus::begin(void)
+{
+  lock();
+  if(_begun == false)
+  {
+    start();
+  }
+  unlock();
+  return _begun;
+}
+
+/**
+ *   @brief the controller with our clock and timeout; also after a recovery
+ */
+void I2cBus::start(void)
+{
+  _begun = Wire.begin(SDA, SCL, _clockHz);
+  Wire.setTimeOut(I2C_BUS_TIMEOUT_MS);
+}
+
+/**
+ *
+ */
+int8_t I2cBus::attach(uint8_t address, uint32_t maxClockHz, const char *name)
+{
+  int8_t dev = find(address);
+  if(dev >= 0)
+  {
+    return dev;
+  }
+  if(_count >= I2C_BUS_MAX_DEVICES)
+  {
+    return -1;
+  }
+  dev = (int8_t)_count;
+  _dev[dev].address    = address;
+  _dev[dev].name       = name;
+  _dev[dev].maxClockHz = maxClockHz;
+  _count++;
+  negotiateClock();
+  return dev;
+}
+
+/**
+ *
+ */
+int8_t I2cBus::find(uint8_t address) const
+{
+  for(uint8_t n = 0u; n < _count; n++)
+  {
+    if(_dev[n].address == address)
+    {
+      return (int8_t)n;
+    }
+  }
+  return -1;
+}
+
+/**
+ *   @brief the slowest attached device sets the pace
+ */
+void I2cBus::negotiateClock(void)
+{
+  uint32_t clock = I2C_FAST_MODE_HZ;
+  for(uint8_t n = 0u; n < _count; n++)
+  {
+    if(_dev[n].maxClockHz < clock)
+    {
+      clock = _dev[n].maxClockHz;
+    }
+  }
+  if(clock == _clockHz)
+  {
+    return;
+  }
+  _clockHz = clock;
+  if(_begun)
+  {
+    lock();
+    Wire.setClock(_clockHz);
+    unlock();
+  }
+}
+
+/**
+ *
+ */
+void I2cBus::lock(void)
+{
+  if(_mutex == NULL)
+  {
+    _mutex = xSemaphoreCreateRecursiveMutex();
+  }
+  xSemaphoreTakeRecursive(_mutex, portMAX_DELAY);
+}
+
+/**
+ *
+ */
+void I2cBus::unlock(void)
+{
+  xSemaphoreGiveRecursive(_mutex);
+}
+
+/**
+ *   @brief one try on the wire, no retries, no accounting
+ */
+I2cResult I2cBus::attempt(uint8_t address, const i2cOp_t &op, uint8_t *got, uint8_t *written)
+{
+  *got = 0u;
+  *written = 0u;
+  if(op.addressReg)
+  {
+    Wire.beginTransmission(address);
+    Wire.write(op.reg);
+    if(op.outLen > 0u)
+    {
+      Wire.write(op.out, op.outLen);
+    }
+    uint8_t err = Wire.endTransmission(true);
+    *written = 1u + op.outLen;
+    if(err == 5u)
+    {
+      return I2C_RESULT_TIMEOUT;
+    }
+    if(err != 0u)
+    {
+      return I2C_RESULT_NACK;
+    }
+  }
+  if(op.inLen == 0u)
+  {
+    return I2C_RESULT_OK;
+  }
+  uint32_t t0 = micros();
+  Wire.requestFrom(address, op.inLen, (uint8_t)1u);
+  uint8_t n = 0u;
+  while((Wire.available() > 0) && (n < op.inLen))
+  {
+    op.in[n++] = Wire.read();
+  }
+  *got = n;
+  if((n == 0u) && ((micros() - t0) >= (I2C_BUS_TIMEOUT_MS * 1000u)))
+  {
+    return I2C_RESULT_TIMEOUT;
+  }
+  if((op.exact == false) || (n == op.inLen))
+  {
+    return I2C_RESULT_OK;
+  }
+  if((n == 0u) && (op.addressReg == false))
+  {
+    /* nothing came back for a bare read: the address was not acknowledged */
+    return I2C_RESULT_BUSY;
+  }
+  return I2C_RESULT_SHORT_READ;
+}
+
+/**
+ *   @brief a timeout or a low SDA between attempts calls for a recovery before the next try;
+ *          BUSY is the device's answer, so it is neither retried nor a failure
+ */
+I2cResult I2cBus::transfer(int8_t dev, const i2cOp_t &op, uint8_t *got)
+{
+  uint8_t dummy;
+  if(got == NULL)
+  {
+    got = &dummy;
+  }
+  *got = 0u;
+  if((dev < 0) || (dev >= (int8_t)_count))
+  {
+    return I2C_RESULT_NO_DEVICE;
+  }
+  lock();
+  if(_begun == false)
+  {
+    start();
+  }
+  i2cDeviceStats_t &d = _dev[dev];
+  uint32_t t0 = micros();
+  uint8_t written;
+  I2cResult result;
+  for(uint8_t tries = 0u; ; tries++)
+  {
+    result = attempt(d.address, op, got, &written);
+    d.bytesWritten += written;
+    d.bytesRead += *got;
+    if(result == I2C_RESULT_TIMEOUT)
+    {
+      d.timeouts++;
+    }
+    if(i2cFailed(result) == false)
+    {
+      break;
+    }
+    if((result == I2C_RESULT_TIMEOUT) || (digitalRead(SDA) == LOW))
+    {
+      if(recover() == false)
+      {
+        result = I2C_RESULT_BUS_STUCK;
+        break;
+      }
+    }
+    if(tries >= I2C_BUS_RETRIES)
+    {
+      break;
+    }
+    d.retries++;
+  }
+  uint32_t us = micros() - t0;
+  d.transactions++;
+  d.busUs += us;
+  if(us > d.maxUs)
+  {
+    d.maxUs = us;
+  }
+  d.lastResult = result;
+  if(i2cFailed(result))
+  {
+    d.failures++;
+    d.failStreak++;
+  }
+  else
+  {
+    d.failStreak = 0u;
+  }
+  unlock();
+  return result;
+}
+
+/**
+ *   @brief called with the bus locked
+ */
+bool I2cBus::recover(void)
+{
+  _recoveries++;
+  Wire.end();
+  pinMode(SDA, INPUT_PULLUP);
+  pinMode(SCL, OUTPUT_OPEN_DRAIN);
+  digitalWrite(SCL, HIGH);
+  delayMicroseconds(I2C_RECOVERY_HALF_US);
+  for(uint8_t n = 0u; (n < I2C_RECOVERY_CLOCKS) && (digitalRead(SDA) == LOW); n++)
+  {
+    digitalWrite(SCL, LOW);
+    delayMicroseconds(I2C_RECOVERY_HALF_US);
+    digitalWrite(SCL, HIGH);
+    delayMicroseconds(I2C_RECOVERY_HALF_US);
+  }
+  /* START then STOP, so every slave is back to waiting for its address */
+  pinMode(SDA, OUTPUT_OPEN_DRAIN);
+  digitalWrite(SDA, LOW);
+  delayMicroseconds(I2C_RECOVERY_HALF_US);
+  digitalWrite(SDA, HIGH);
+  delayMicroseconds(I2C_RECOVERY_HALF_US);
+  pinMode(SDA, INPUT_PULLUP);
+  pinMode(SCL, INPUT_PULLUP);
+  _stuck = (digitalRead(SDA) == LOW) || (digitalRead(SCL) == LOW);
+  start();
+  return _stuck == false;
+}
+
+/**
+ *
+ */
+I2cResult I2cBus::read(int8_t dev, uint8_t reg, uint8_t *in, uint8_t len)
+{
+  i2cOp_t op = { true, reg, NULL, 0u, in, len, true };
+  return transfer(dev, op, NULL);
+}
+
+/**
+ *
+ */
+I2cResult I2cBus::readUpTo(int8_t dev, uint8_t reg, uint8_t *in, uint8_t maxLen, uint8_t *got)
+{
+  i2cOp_t op = { true, reg, NULL, 0u, in, maxLen, false };
+  return transfer(dev, op, got);
+}
+
+/**
+ *
+ */
+I2cResult I2cBus::receive(int8_t dev, uint8_t *in, uint8_t len)
+{
+  i2cOp_t op = { false, 0u, NULL, 0u, in, len, true };
+  return transfer(dev, op, NULL);
+}
+
+/**
+ *
+ */
+I2cResult I2cBus::write(int8_t dev, uint8_t reg, const uint8_t *out, uint8_t len)
+{
+  i2cOp_t op = { true, reg, out, len, NULL, 0u, true };
+  return transfer(dev, op, NULL);
+}
+
+/* registers from t on that follow each other, at most I2C_BUS_MAX_BURST */
+static uint8_t runLength(const i2cRegValue_t *t, uint8_t left)
+{
+  uint8_t len = 1u;
+  while((len < left) && (len < I2C_BUS_MAX_BURST) && (t[len].reg == (uint8_t)(t[len - 1u].reg + 1u)))
+  {
+    len++;
+  }
+  return len;
+}
+
+/**
+ *   @brief the bus stays locked from the first write to the last read-back, so no other task
+ *          sees the device half configured
+ */
+I2cResult I2cBus::writeTable(int8_t dev, const i2cRegValue_t *table, uint8_t count)
+{
+  uint8_t buf[I2C_BUS_MAX_BURST];
+  uint8_t len;
+  I2cResult result = I2C_RESULT_OK;
+  lock();
+  for(uint8_t n = 0u; (n < count) && (result == I2C_RESULT_OK); n += len)
+  {
+    len = runLength(&table[n], count - n);
+    for(uint8_t k = 0u; k < len; k++)
+    {
+      buf[k] = table[n + k].value;
+    }
+    result = write(dev, table[n].reg, buf, len);
+  }
+  for(uint8_t n = 0u; (n < count) && (result == I2C_RESULT_OK); n += len)
+  {
+    len = runLength(&table[n], count - n);
+    result = read(dev, table[n].reg, buf, len);
+    for(uint8_t k = 0u; (k < len) && (result == I2C_RESULT_OK); k++)
+    {
+      if(((buf[k] ^ table[n + k].value) & table[n + k].verifyMask) != 0u)
+      {
+        result = I2C_RESULT_MISMATCH;
+        _dev[dev].failures++;
+        _dev[dev].lastResult = result;
+      }
+    }
+  }
+  unlock();
+  return result;
+}
+
+/**
+ *   @brief address only, so nothing to retry: absent is the answer
+ */
+bool I2cBus::probe(int8_t dev)
+{
+  if((dev < 0) || (dev >= (int8_t)_count))
+  {
+    return false;
+  }
+  lock();
+  if(_begun == false)
+  {
+    start();
+  }
+  i2cDeviceStats_t &d = _dev[dev];
+  uint32_t t0 = micros();
+  Wire.beginTransmission(d.address);
+  I2cResult result = (Wire.endTransmission(true) == 0) ? I2C_RESULT_OK : I2C_RESULT_NACK;
+  d.transactions++;
+  d.busUs += micros() - t0;
+  d.lastResult = result;
+  unlock();
+  return result == I2C_RESULT_OK;
+}
+
+/**
+ *   @brief an absent board is the expected answer of a scan, so no retries and no recovery
+ */
+I2cResult I2cBus::peek(uint8_t address, uint8_t reg, uint8_t *value)
+{
+  i2cOp_t op = { true, reg, NULL, 0u, value, 1u, true };
+  uint8_t got;
+  uint8_t written;
+  lock();
+  if(_begun == false)
+  {
+    start();
+  }
+  I2cResult result = attempt(address, op, &got, &written);
+  unlock();
+  return result;
+}
+
+/**
+ *
+ */
+i2cDeviceStats_t I2cBus::stats(int8_t dev)
+{
+  i2cDeviceStats_t copy;
+  memset(&copy, 0, sizeof(copy));
+  if((dev < 0) || (dev >= (int8_t)_count))
+  {
+    return copy;
+  }
+  lock();
+  copy = _dev[dev];
+  unlock();
+  return copy;
+}
+
+/**
+ *
+ */
+I2cResult I2cBus::lastResult(int8_t dev) const
+{
+  if((dev < 0) || (dev >= (int8_t)_count))
+  {
+    return I2C_RESULT_NO_DEVICE;
+  }
+  return _dev[dev].lastResult;
+}
@@ -0,0 +1,166 @@
+/*
+  This code is developed under the MYOSA (LearnTheEasyWay) initiative of MakeSense EduTech and Pegasus Automation.
+
+  Synopsis of I2cBus
+  One owner for the shared I2C bus of all MYOSA board libraries.
+  Each driver attaches its device once, with the fastest SCL clock the chip supports; the bus runs at
+  the slowest of those, so one standard mode part slows everyone down and none is ever overclocked.
+  Every transaction takes a recursive mutex, so drivers may be called from any task, and is counted per
+  device: transactions, bytes written (register address included) and read, and time on the bus.
+
+  Drivers talk to the bus only through read()/receive()/write()/probe(); nothing else should call
+  Wire directly. A sequence that must not be interleaved with other traffic goes between lock() and
+  unlock().
+
+  Faults are bounded and reported, never hidden. Wire gives up on a transaction after
+  I2C_BUS_TIMEOUT_MS, and a failed transaction is retried at most I2C_BUS_RETRIES times. Before a
+  retry, a bus left with SDA low (a slave stopped mid byte, typically by a reset or brown-out of the
+  master) is recovered: up to nine SCL pulses shift the slave out of its byte, a STOP ends the
+  transfer, and the controller is restarted. What still fails reaches the driver as an I2cResult and
+  stays in the device's counters, together with the worst transaction time.
+
+  A driver's default configuration can be given as a table of register values and written with
+  writeTable(): runs of adjacent registers go out as one burst each, then every run is read back
+  once and compared, so bring-up takes a handful of transactions instead of a read-modify-write
+  per field.
+
+  NOTE
+  Unless required by applicable law or agreed to in writing, this software is distributed on an
+  "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied
+*/
+
+#ifndef __I2CBUS_H__
+#define __I2CBUS_H__
+
+#include <stdint.h>
+#include <Arduino.h>
+#include <Wire.h>
+
+#define I2C_BUS_MAX_DEVICES     8u
+#define I2C_STANDARD_MODE_HZ    100000u
+#define I2C_FAST_MODE_HZ        400000u
+#define I2C_BUS_TIMEOUT_MS      25u     /* longest legal clock stretch: Si7021 hold master RH+T, 23 ms */
+#define I2C_BUS_RETRIES         2u      /* attempts after the first failed one */
+#define I2C_RECOVERY_CLOCKS     9u      /* a stuck slave releases SDA within one byte plus ACK */
+#define I2C_RECOVERY_HALF_US    5u      /* 100 kHz while bit-banging */
+#define I2C_BUS_MAX_BURST       16u     /* registers per burst of writeTable(), also its stack buffer */
+
+/* everything after I2C_RESULT_BUSY is a fault */
+enum I2cResult : uint8_t
+{
+  I2C_RESULT_OK,
+  I2C_RESULT_BUSY,          /**< receive() not acknowledged: conversion still running, not a fault */
+  I2C_RESULT_NACK,          /**< address or register write not acknowledged */
+  I2C_RESULT_SHORT_READ,    /**< device returned fewer bytes than asked for */
+  I2C_RESULT_TIMEOUT,       /**< SCL held low longer than I2C_BUS_TIMEOUT_MS */
+  I2C_RESULT_BUS_STUCK,     /**< SDA still low after recovery */
+  I2C_RESULT_MISMATCH,      /**< writeTable() read back something else than it wrote */
+  I2C_RESULT_NO_DEVICE      /**< handle not attached */
+};
+
+static inline bool i2cFailed(I2cResult result)
+{
+  return result > I2C_RESULT_BUSY;
+}
+
+/*!
+ * Traffic of one attached device
+ */
+typedef struct
+{
+  uint8_t address;
+  const char *name;
+  uint32_t maxClockHz;
+  uint32_t transactions;
+  uint32_t failures;          /**< transactions that failed after all retries */
+  uint32_t retries;
+  uint32_t timeouts;          /**< attempts that ran into I2C_BUS_TIMEOUT_MS */
+  uint32_t bytesWritten;
+  uint32_t bytesRead;
+  uint32_t busUs;             /**< retries and recovery included */
+  uint32_t maxUs;             /**< slowest transaction */
+  uint16_t failStreak;        /**< failed transactions in a row, 0 once one succeeds */
+  I2cResult lastResult;
+}i2cDeviceStats_t;
+
+/*!
+ * One register of an initialisation table
+ */
+typedef struct
+{
+  uint8_t reg;
+  uint8_t value;
+  uint8_t verifyMask;         /**< bits compared on read-back; reserved and self-clearing bits left out */
+}i2cRegValue_t;
+
+/*!
+ * One transaction as the retry loop sees it
+ */
+typedef struct
+{
+  bool addressReg;            /**< write reg (and out) first */
+  uint8_t reg;
+  const uint8_t *out;
+  uint8_t outLen;
+  uint8_t *in;
+  uint8_t inLen;              /**< 0: write only */
+  bool exact;                 /**< fewer than inLen bytes is a short read */
+}i2cOp_t;
+
+class I2cBus
+{
+  public:
+    /* the one bus all drivers share; safe to use from global constructors */
+    static I2cBus &shared(void);
+    /* Wire.begin() at the negotiated clock; also done by the first transaction */
+    bool begin(void);
+    /* register a device, or find it again; returns its handle, -1 when the table is full */
+    int8_t attach(uint8_t address, uint32_t maxClockHz, const char *name);
+    /* handle of an attached address, -1 if none */
+    int8_t find(uint8_t address) const;
+    /* write reg, then read len bytes */
+    I2cResult read(int8_t dev, uint8_t reg, uint8_t *in, uint8_t len);
+    /* read len bytes without addressing a register (results of a command); BUSY while the device NACKs */
+    I2cResult receive(int8_t dev, uint8_t *in, uint8_t len);
+    /* write reg, then up to maxLen bytes, however many the device returns (0 included); count in *got */
+    I2cResult readUpTo(int8_t dev, uint8_t reg, uint8_t *in, uint8_t maxLen, uint8_t *got);
+    /* write reg followed by len bytes; len 0 writes a command or the register pointer only */
+    I2cResult write(int8_t dev, uint8_t reg, const uint8_t *out, uint8_t len);
+    /* burst write runs of adjacent registers in table order, then read each run back once */
+    I2cResult writeTable(int8_t dev, const i2cRegValue_t *table, uint8_t count);
+    /* address only, true when acknowledged */
+    bool probe(int8_t dev);
+    /* one register of an address that need not be attached, for a bus scan: one try, not counted */
+    I2cResult peek(uint8_t address, uint8_t reg, uint8_t *value);
+    /* hold the bus across several transactions, nests */
+    void lock(void);
+    void unlock(void);
+    uint32_t clockHz(void) const { return _clockHz; }
+    uint8_t devices(void) const { return _count; }
+    /* a copy, taken under the lock */
+    i2cDeviceStats_t stats(int8_t dev);
+    /* outcome of the device's last transaction, no lock needed */
+    I2cResult lastResult(int8_t dev) const;
+    /* bus recoveries since boot, and whether the last one left SDA stuck */
+    uint32_t recoveries(void) const { return _recoveries; }
+    bool stuck(void) const { return _stuck; }
+  private:
+    I2cBus();
+    SemaphoreHandle_t _mutex;
+    bool _begun;
+    uint32_t _clockHz;
+    uint8_t _count;
+    uint32_t _recoveries;
+    bool _stuck;
+    i2cDeviceStats_t _dev[I2C_BUS_MAX_DEVICES];
+
+    void start(void);
+    void negotiateClock(void);
+    /* the retry loop around attempt(), under the lock, with accounting */
+    I2cResult transfer(int8_t dev, const i2cOp_t &op, uint8_t *got);
+    I2cResult attempt(uint8_t address, const i2cOp_t &op, uint8_t *got, uint8_t *written);
+    /* clock SDA free, STOP, restart the controller; true when both lines are high again */
+    bool recover(void);
+};
+
+#endif
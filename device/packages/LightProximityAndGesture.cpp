@@ -26,12 +26,52 @@
 
 #include "LightProximityAndGesture.h"
 
+/**
+ * Default configuration written by begin(), in table order. Adjacent registers share one burst,
+ * ENABLE goes first so nothing runs while the rest is set. Reserved bits are not compared.
+ */
+static const i2cRegValue_t apds9960Defaults[] =
+{
+  { APDS9960_ENABLE,      0u,                                               0x7Fu },
+  { APDS9960_ATIME,       DEFAULT_ATIME,                                    0xFFu },
+  { APDS9960_WTIME,       DEFAULT_WTIME,                                    0xFFu },
+  { APDS9960_AILTL,       DEFAULT_AILT & 0xFFu,                             0xFFu },
+  { APDS9960_AILTH,       DEFAULT_AILT >> 8u,                               0xFFu },
+  { APDS9960_AIHTL,       DEFAULT_AIHT & 0xFFu,                             0xFFu },
+  { APDS9960_AIHTH,       DEFAULT_AIHT >> 8u,                               0xFFu },
+  { APDS9960_PILT,        DEFAULT_PILT,                                     0xFFu },
+  { APDS9960_PIHT,        DEFAULT_PIHT,                                     0xFFu },
+  { APDS9960_PERS,        DEFAULT_PERS,                                     0xFFu },
+  { APDS9960_CONFIG1,     DEFAULT_CONFIG1,                                  0x02u },
+  { APDS9960_PPULSE,      DEFAULT_PROX_PPULSE,                              0xFFu },
+  { APDS9960_CONTROL,     (DEFAULT_LDRIVE << LED_DRIVE_POS) | (DEFAULT_PGAIN << PRX_GAIN_POS) |
+                          (DEFAULT_AGAIN << ALS_GAIN_POS),                  0xCFu },
+  { APDS9960_CONFIG2,     DEFAULT_CONFIG2,                                  0xF0u },
+  { APDS9960_POFFSET_UR,  DEFAULT_POFFSET_UR,                               0xFFu },
+  { APDS9960_POFFSET_DL,  DEFAULT_POFFSET_DL,                               0xFFu },
+  { APDS9960_CONFIG3,     DEFAULT_CONFIG3,                                  0x3Fu },
+  { APDS9960_GPENTH,      DEFAULT_GPENTH,                                   0xFFu },
+  { APDS9960_GEXTH,       DEFAULT_GEXTH,                                    0xFFu },
+  { APDS9960_GCONF1,      DEFAULT_GCONF1,                                   0xFFu },
+  { APDS9960_GCONF2,      (DEFAULT_GGAIN << GES_GAIN_POS) | (DEFAULT_GLDRIVE << GES_LDRIVE_POS) |
+                          (DEFAULT_GWTIME << GES_WTIME_POS),                0x7Fu },
+  { APDS9960_GOFFSET_U,   DEFAULT_GOFFSET,                                  0xFFu },
+  { APDS9960_GOFFSET_D,   DEFAULT_GOFFSET,                                  0xFFu },
+  { APDS9960_GPULSE,      DEFAULT_GPULSE,                                   0xFFu },
+  { APDS9960_GOFFSET_L,   DEFAULT_GOFFSET,                                  0xFFu },
+  { APDS9960_GOFFSET_R,   DEFAULT_GOFFSET,                                  0xFFu },
+  { APDS9960_GCONF3,      DEFAULT_GCONF3,                                   0x03u },
+  /* gesture interrupt off (DEFAULT_GIEN), gesture mode off; GFIFO_CLR clears itself */
+  { APDS9960_GCONF4,      DEFAULT_GIEN << GES_GIEN_POS,                     0x03u },
+};
+
 /**
  *
  */
 LightProximityAndGesture::LightProximityAndGesture()
 {
   _i2cSlaveAddress = APDS9960_I2C_ADDRESS;
+  i2c_init();
 }
 
 /**
@@ -71,126 +111,8 @@ bool LightProximityAndGesture::begin(void)
   {
     return false;
   }
-  /* Set ENABLE register to 0 (disable all features) */
-  if( !writeByte(APDS9960_ENABLE,0u) )
-  {
-    return false;
-  }
-  /* Set default values for ambient light and proximity registers */
-  if( !writeByte(APDS9960_ATIME,DEFAULT_ATIME) )
-  {
-    return false;
-  }
-  if( !writeByte(APDS9960_WTIME,DEFAULT_WTIME) )
-  {
-    return false;
-  }
-  if( !writeByte(APDS9960_PPULSE,DEFAULT_PROX_PPULSE) )
-  {
-    return false;
-  }
-  if( !writeByte(APDS9960_POFFSET_UR,DEFAULT_POFFSET_UR) )
-  {
-    return false;
-  }
-  if( !writeByte(APDS9960_POFFSET_DL,DEFAULT_POFFSET_DL) )
-  {
-    return false;
-  }
-  if( !writeByte(APDS9960_CONFIG1,DEFAULT_CONFIG1) )
-  {
-    return false;
-  }
-  if( !setLedDrive(DEFAULT_LDRIVE) )
-  {
-    return false;
-  }
-  if( !setProximityGain(DEFAULT_PGAIN) )
-  {
-    return false;
-  }
-  if( !setAmbientLightGain(DEFAULT_AGAIN) )
-  {
-    return false;
-  }
-  if( !writeByte(APDS9960_PILT,DEFAULT_PILT))
-  {
-    return false;
-  }
-  if( !writeByte(APDS9960_PIHT,DEFAULT_PIHT))
-  {
-    return false;
-  }
-  if( !setLightIntLowThreshold(DEFAULT_AILT) )
-  {
-    return false;
-  }
-  if( !setLightIntHighThreshold(DEFAULT_AIHT) )
-  {
-    return false;
-  }
-  if( !writeByte(APDS9960_PERS, DEFAULT_PERS) )
-  {
-    return false;
-  }
-  if( !writeByte(APDS9960_CONFIG2, DEFAULT_CONFIG2) )
-  {
-    return false;
-  }
-  if( !writeByte(APDS9960_CONFIG3, DEFAULT_CONFIG3) )
-  {
-    return false;
-  }
-  /* Set default values for gesture sense registers */
-  if( !writeByte(APDS9960_GPENTH,DEFAULT_GPENTH) )
-  {
-    return false;
-  }
-  if( !writeByte(APDS9960_GEXTH,DEFAULT_GEXTH) )
-  {
-    return false;
-  }
-  if( !writeByte(APDS9960_GCONF1, DEFAULT_GCONF1) )
-  {
-    return false;
-  }
-  if( !setGestureGain(DEFAULT_GGAIN) )
-  {
-    return false;
-  }
-  if( !setGestureLedDrive(DEFAULT_GLDRIVE) )
-  {
-    return false;
-  }
-  if( !setGestureWaitTime(DEFAULT_GWTIME) )
-  {
-    return false;
-  }
-  if( !writeByte(APDS9960_GOFFSET_U, DEFAULT_GOFFSET) )
-  {
-    return false;
-  }
-  if( !writeByte(APDS9960_GOFFSET_D, DEFAULT_GOFFSET) )
-  {
-    return false;
-  }
-  if( !writeByte(APDS9960_GOFFSET_L, DEFAULT_GOFFSET) )
-  {
-    return false;
-  }
-  if( !writeByte(APDS9960_GOFFSET_R, DEFAULT_GOFFSET) )
-  {
-    return false;
-  }
-  if( !writeByte(APDS9960_GPULSE, DEFAULT_GPULSE) )
-  {
-    return false;
-  }
-  if( !writeByte(APDS9960_GCONF3, DEFAULT_GCONF3) )
-  {
-    return false;
-  }
-  if( !setGestureInt(DISABLE) )
+  /* all engines off, then the defaults: six bursts and six read-backs */
+  if( !writeTable(apds9960Defaults, sizeof(apds9960Defaults)/sizeof(apds9960Defaults[0])) )
   {
     return false;
   }
@@ -1321,7 +1243,7 @@ int LightProximityAndGesture::readGesture(void)
 /**
  *
  */
-uint16_t *LightProximityAndGesture::getRGBProportion(bool print)
+uint16_t *LightProximityAndGesture::getRGBProportion(void)
 {
   static uint16_t color[3u];
   color[0u] = color[1u] = color[2u] = 0u;
@@ -1331,18 +1253,9 @@ uint16_t *LightProximityAndGesture::getRGBProportion(bool print)
       {
           if(readBlueLight(&color[2u]))
           {
-              if(print)
-              {
-                  Serial.print("Red:");
-                  Serial.print(color[0u]);
-                  Serial.println("%");
-                  Serial.print("Green:");
-                  Serial.print(color[1u]);
-                  Serial.println("%");
-                  Serial.print("Blue:");
-                  Serial.print(color[2u]);
-                  Serial.println("%");
-              }
+              MYOSA_LOGI("Red:", color[0u], "%");
+              MYOSA_LOGI("Green:", color[1u], "%");
+              MYOSA_LOGI("Blue:", color[2u], "%");
           }
       }
   }
@@ -1352,17 +1265,12 @@ uint16_t *LightProximityAndGesture::getRGBProportion(bool print)
 /**
  *
  */
-uint16_t LightProximityAndGesture::getAmbientLight(bool print)
+uint16_t LightProximityAndGesture::getAmbientLight(void)
 {
     uint16_t ambient_light;
     if(readAmbientLight(&ambient_light))
     {
-        if(print)
-        {
-            Serial.print("Ambient Light: ");
-            Serial.print(ambient_light);
-            Serial.println("Lux");
-        }
+        MYOSA_LOGI("Ambient Light: ", ambient_light, "Lux");
         return ambient_light;
     }
     return 0u;
@@ -1410,66 +1318,79 @@ uint16_t LightProximityAndGesture::getBlueProportion(void)
 /**
  *
  */
-float LightProximityAndGesture::getProximity(bool print)
+float LightProximityAndGesture::getProximity(void)
 {
     uint8_t proximity_data = 0;
     if(readProximity(&proximity_data))
     {
-        if(print)
-        {
-            Serial.print("Proximity: ");
-            Serial.print((float)proximity_data,2);
-            Serial.println();
-        }
+        MYOSA_LOGI("Proximity: ", (float)proximity_data);
         return (float)proximity_data;
     }
-    return 0.0f;
+    return NAN;
+}
+
+/**
+ *   @brief true once an ALS integration cycle has completed
+ */
+bool LightProximityAndGesture::isAmbientLightValid(void)
+{
+    uint8_t status;
+    if(readByte(APDS9960_STATUS,&status) == false)
+    {
+        return false;
+    }
+    return (status & STATUS_AVALID_MSK) != 0u;
+}
+
+/**
+ *   @brief true once a proximity cycle has completed
+ */
+bool LightProximityAndGesture::isProximityValid(void)
+{
+    uint8_t status;
+    if(readByte(APDS9960_STATUS,&status) == false)
+    {
+        return false;
+    }
+    return (status & STATUS_PVALID_MSK) != 0u;
 }
 
 /**
  *
  */
-char *LightProximityAndGesture::getGesture(bool print)
+char *LightProximityAndGesture::getGesture(void)
 {
     char *gesture = (char *)"NONE";
     if(isGestureAvailable())
     {
-      Serial.print("Gesture: ");
       switch(readGesture())
       {
         case DIR_UP:
           gesture = (char *)"UP";
-          Serial.println("UP");
           break;
         case DIR_DOWN:
           gesture = (char *)"DOWN";
-          Serial.println("DOWN");
           break;
         case DIR_LEFT:
           gesture = (char *)"LEFT";
-          Serial.println("LEFT");
           break;
         case DIR_RIGHT:
           gesture = (char *)"RIGHT";
-          Serial.println("RIGHT");
           break;
         case DIR_NEAR:
           gesture = (char *)"NEAR";
-          Serial.println("NEAR");
           break;
         case DIR_FAR:
           gesture = (char *)"FAR";
-          Serial.println("FAR");
           break;
         case TIMEOUT:
           gesture = (char *)"TIMEOUT";
-          Serial.println("TIMEOUT");
           break;
         default:
           gesture = (char *)"NONE";
-          Serial.println("NONE");
           break;
       }
+      MYOSA_LOGI("Gesture: ", gesture);
     }
     return gesture;
 }
@@ -1478,12 +1399,11 @@ char *LightProximityAndGesture::getGesture(bool print)
 * Platform dependent routines. Change these functions implementation based on microcontroller *
 ***********************************************************************************************/
 /**
- *
+ *   @brief attach to the shared bus, which starts with the first transaction
  */
 void LightProximityAndGesture::i2c_init(void)
 {
-  Wire.begin();
-  Wire.setClock(100000);
+  _bus = I2cBus::shared().attach(_i2cSlaveAddress, APDS9960_I2C_MAX_HZ, "apds9960");
 }
 
 /**
@@ -1491,19 +1411,7 @@ void LightProximityAndGesture::i2c_init(void)
  */
 bool LightProximityAndGesture::readByte(uint8_t reg, uint8_t *in)
 {
-  Wire.beginTransmission((uint8_t)_i2cSlaveAddress);
-  Wire.write(reg);
-  if(Wire.endTransmission(true) != 0)
-  {
-    return false;
-  }
-  Wire.requestFrom((uint8_t)_i2cSlaveAddress, (uint8_t)1u, (uint8_t)1u);
-  if(Wire.available() != 1u)
-  {
-    return false;
-  }
-  *in = Wire.read();
-  return true;
+  return I2cBus::shared().read(_bus, reg, in, 1u) == I2C_RESULT_OK;
 }
 
 /**
@@ -1511,24 +1419,12 @@ bool LightProximityAndGesture::readByte(uint8_t reg, uint8_t *in)
  */
 int8_t LightProximityAndGesture::readMultiBytes(uint8_t reg, uint8_t length, uint8_t *in)
 {
-  int8_t nData = 0u;
-  Wire.beginTransmission((uint8_t)_i2cSlaveAddress);
-  Wire.write(reg);
-  if(Wire.endTransmission(true) != 0)
+  uint8_t got;
+  if(I2cBus::shared().readUpTo(_bus, reg, in, length, &got) != I2C_RESULT_OK)
   {
     return -1;
   }
-  Wire.requestFrom((uint8_t)_i2cSlaveAddress, length, 1u);
-  while(Wire.available())
-  {
-    if(nData >= length)
-    {
-      return -1;
-    }
-    in[nData] = Wire.read();
-    nData++;
-  }
-  return nData;
+  return (int8_t)got;
 }
 
 /**
@@ -1536,17 +1432,7 @@ int8_t LightProximityAndGesture::readMultiBytes(uint8_t reg, uint8_t length, uin
  */
 bool LightProximityAndGesture::readMultiBytes(uint8_t length, uint8_t *in)
 {
-  Wire.requestFrom((uint8_t)_i2cSlaveAddress, (uint8_t)length, (uint8_t)1u);
-  if(Wire.available() != length)
-  {
-    return false;
-  }
-  uint8_t nData;
-  for(nData = 0u; nData < length; nData++)
-  {
-    in[nData] = Wire.read();
-  }
-  return true;
+  return I2cBus::shared().receive(_bus, in, length) == I2C_RESULT_OK;
 }
 
 /**
@@ -1554,13 +1440,7 @@ bool LightProximityAndGesture::readMultiBytes(uint8_t length, uint8_t *in)
  */
 bool LightProximityAndGesture::writeByte(uint8_t reg)
 {
-  Wire.beginTransmission((uint8_t)_i2cSlaveAddress);
-  Wire.write(reg);
-  if (Wire.endTransmission(true) == 0)
-  {
-    return true;
-  }
-  return false;
+  return I2cBus::shared().write(_bus, reg, NULL, 0u) == I2C_RESULT_OK;
 }
 
 /**
@@ -1568,14 +1448,7 @@ bool LightProximityAndGesture::writeByte(uint8_t reg)
  */
 bool LightProximityAndGesture::writeByte(uint8_t reg, uint8_t val)
 {
-  Wire.beginTransmission((uint8_t)_i2cSlaveAddress);
-  Wire.write(reg);
-  Wire.write(val);
-  if (Wire.endTransmission(true) == 0)
-  {
-    return true;
-  }
-  return false;
+  return I2cBus::shared().write(_bus, reg, &val, 1u) == I2C_RESULT_OK;
 }
 
 /**
@@ -1583,12 +1456,23 @@ bool LightProximityAndGesture::writeByte(uint8_t reg, uint8_t val)
  */
 bool LightProximityAndGesture::writeAddress(void)
 {
-  Wire.beginTransmission((uint8_t)_i2cSlaveAddress);
-  if (Wire.endTransmission(true) == 0)
-  {
-    return true;
-  }
-  return false;
+  return I2cBus::shared().probe(_bus);
+}
+
+/**
+ *
+ */
+bool LightProximityAndGesture::writeTable(const i2cRegValue_t *table, uint8_t count)
+{
+  return I2cBus::shared().writeTable(_bus, table, count) == I2C_RESULT_OK;
+}
+
+/**
+ *
+ */
+I2cResult LightProximityAndGesture::busResult(void) const
+{
+  return I2cBus::shared().lastResult(_bus);
 }
 
 /**
@@ -24,13 +24,19 @@
   Email: dev.myosa@gmail.com
 */
 
+#ifndef __LIGHTPROXIMITYANDGESTURE_H__
+#define __LIGHTPROXIMITYANDGESTURE_H__
+
 #include <stdint.h>
 #include <math.h>
 #include <Arduino.h>
 #include <Wire.h>
+#include <MyosaLog.h>
+#include <I2cBus.h>
 
 /* APDS-9960 I2C address */
 #define APDS9960_I2C_ADDRESS    0x39
+#define APDS9960_I2C_MAX_HZ     400000u   /* fast mode */
 
 /* Gesture parameters */
 #define GESTURE_THRESHOLD_OUT   10
@@ -144,6 +150,10 @@
 #define CFG2_LED_BOOST_MSK      0x30u
 #define CFG2_LED_BOOST_POS      0x04u
 
+/* Status register masks */
+#define STATUS_AVALID_MSK       0x01u
+#define STATUS_PVALID_MSK       0x02u
+
 /* Gesture status masks */
 #define GES_STATUS_MSK          0x01u
 #define GSTS_GVALID_MSK         0x01u
@@ -283,6 +293,8 @@ class LightProximityAndGesture
     bool begin(void);
     uint8_t getDeviceId(void);
     bool ping(void);
+    /* outcome of the last bus transaction, the reason when a call above failed */
+    I2cResult busResult(void) const;
     uint8_t getMode(void);
     bool setMode(APDS9960_MODE_t mode, STATE_t state);
      /* Turn the APDS-9960 on and off */
@@ -328,15 +340,20 @@ class LightProximityAndGesture
     bool clearAmbientLightInt(void);
     bool clearProximityInt(void);
     /* Ambient light methods */
-    uint16_t getAmbientLight(bool print=true);
-    uint16_t *getRGBProportion(bool print=true);
+    bool readAmbientLight(uint16_t *val);
+    uint16_t getAmbientLight(void);
+    uint16_t *getRGBProportion(void);
     uint16_t getRedProportion(void);
     uint16_t getGreenProportion(void);
     uint16_t getBlueProportion(void);
-    /* Proximity methods */
-    float getProximity(bool print=true);
+    /* Proximity methods, NAN when the bus transaction failed */
+    float getProximity(void);
+    bool readProximity(uint8_t *val);
+    /* Data-ready checks for polled (non-blocking) reads */
+    bool isAmbientLightValid(void);
+    bool isProximityValid(void);
     /* Gesture methods */
-    char *getGesture(bool print=true);
+    char *getGesture(void);
   private:
     gesture_data_type_t _gesture_data;
     int _gesture_ud_delta;
@@ -362,17 +379,15 @@ class LightProximityAndGesture
     uint8_t getGestureMode();
     bool setGestureMode(uint8_t mode);
     /* Ambient light methods */
-    bool readAmbientLight(uint16_t *val);
     bool readRedLight(uint16_t *val);
     bool readGreenLight(uint16_t *val);
     bool readBlueLight(uint16_t *val);
-    /* Proximity methods */
-    bool readProximity(uint8_t *val);
     /* Gesture methods */
     bool isGestureAvailable(void);
     int readGesture(void);
     /* low level I2C functions */
     uint8_t _i2cSlaveAddress;
+    int8_t _bus;                  /**< I2cBus handle */
     void i2c_init(void);
     bool readByte(uint8_t reg, uint8_t *in);
     int8_t readMultiBytes(uint8_t reg, uint8_t length, uint8_t *in);
@@ -380,5 +395,8 @@ class LightProximityAndGesture
     bool writeByte(uint8_t reg, uint8_t val);
     bool writeByte(uint8_t reg);
     bool writeAddress(void);
+    bool writeTable(const i2cRegValue_t *table, uint8_t count);
     void delay_ms(uint16_t ms);
 };
+
+#endif
@@ -0,0 +1,172 @@
+/*
+  This code is developed under the MYOSA (LearnTheEasyWay) initiative of MakeSense EduTech and Pegasus Automation.
+
+  Synopsis of MyosaLog
+  Compile-time logging facade shared by all MYOSA board libraries.
+  The level is fixed at build time with MYOSA_LOG_LEVEL (e.g. -DMYOSA_LOG_LEVEL=MYOSA_LOG_INFO);
+  a statement above that level becomes dead code: its arguments are still type checked but never
+  evaluated, and the compiler emits nothing for it.
+  Floats print with 2 decimals, as Serial.print() does by default.
+
+    MYOSA_LOGE / MYOSA_LOGW   bus and configuration failures
+    MYOSA_LOGI                measured values returned by the getters
+    MYOSA_LOGD                calibration and chip identification details
+
+  MYOSA_TRACE(id, value) is a binary channel for debugging at sample rate: fixed 8 byte frames
+  (0xA5, id, 16 bit ms timestamp, 32 bit value, little endian), at most MYOSA_TRACE_RATE per second.
+  A frame is dropped and counted rather than ever waiting on the UART. Off unless MYOSA_TRACE_ENABLE=1.
+
+  NOTE
+  Unless required by applicable law or agreed to in writing, this software is distributed on an
+  "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied
+*/
+
+#ifndef __MYOSALOG_H__
+#define __MYOSALOG_H__
+
+#include <stdint.h>
+#include <Arduino.h>
+
+#define MYOSA_LOG_NONE    0
+#define MYOSA_LOG_ERROR   1
+#define MYOSA_LOG_WARN    2
+#define MYOSA_LOG_INFO    3
+#define MYOSA_LOG_DEBUG   4
+
+#ifndef MYOSA_LOG_LEVEL
+#define MYOSA_LOG_LEVEL   MYOSA_LOG_WARN
+#endif
+
+#ifndef MYOSA_LOG_PORT
+#define MYOSA_LOG_PORT    Serial
+#endif
+
+#ifndef MYOSA_TRACE_ENABLE
+#define MYOSA_TRACE_ENABLE  0
+#endif
+
+#ifndef MYOSA_TRACE_RATE
+#define MYOSA_TRACE_RATE    200u    /* frames per second, bursts of up to one second's worth */
+#endif
+
+#define MYOSA_TRACE_SYNC          0xA5u
+#define MYOSA_TRACE_FRAME_BYTES   8u
+
+/*!
+ * Wrap an integer to log it in hexadecimal
+ */
+typedef struct
+{
+  uint32_t value;
+}myosaHex_t;
+
+inline myosaHex_t myosaHex(uint32_t value)
+{
+  myosaHex_t h = {value};
+  return h;
+}
+
+inline void myosaLogPrint(const myosaHex_t &h)
+{
+  MYOSA_LOG_PORT.print(h.value, HEX);
+}
+
+template <typename T>
+inline void myosaLogPrint(const T &value)
+{
+  MYOSA_LOG_PORT.print(value);
+}
+
+inline void myosaLogLine(void)
+{
+  MYOSA_LOG_PORT.println();
+}
+
+template <typename T, typename... Rest>
+inline void myosaLogLine(const T &first, const Rest &...rest)
+{
+  myosaLogPrint(first);
+  myosaLogLine(rest...);
+}
+
+#if MYOSA_LOG_LEVEL >= MYOSA_LOG_ERROR
+#define MYOSA_LOGE(...)   myosaLogLine(__VA_ARGS__)
+#else
+#define MYOSA_LOGE(...)   do { if(0) { myosaLogLine(__VA_ARGS__); } } while(0)
+#endif
+
+#if MYOSA_LOG_LEVEL >= MYOSA_LOG_WARN
+#define MYOSA_LOGW(...)   myosaLogLine(__VA_ARGS__)
+#else
+#define MYOSA_LOGW(...)   do { if(0) { myosaLogLine(__VA_ARGS__); } } while(0)
+#endif
+
+#if MYOSA_LOG_LEVEL >= MYOSA_LOG_INFO
+#define MYOSA_LOGI(...)   myosaLogLine(__VA_ARGS__)
+#else
+#define MYOSA_LOGI(...)   do { if(0) { myosaLogLine(__VA_ARGS__); } } while(0)
+#endif
+
+#if MYOSA_LOG_LEVEL >= MYOSA_LOG_DEBUG
+#define MYOSA_LOGD(...)   myosaLogLine(__VA_ARGS__)
+#else
+#define MYOSA_LOGD(...)   do { if(0) { myosaLogLine(__VA_ARGS__); } } while(0)
+#endif
+
+#if MYOSA_TRACE_ENABLE
+
+/*!
+ * Token bucket state of the trace channel, one per program
+ */
+typedef struct
+{
+  uint32_t tokens;
+  uint32_t lastRefillMs;
+  uint32_t sent;
+  uint32_t dropped;
+}myosaTraceState_t;
+
+inline myosaTraceState_t &myosaTraceState(void)
+{
+  static myosaTraceState_t state = {MYOSA_TRACE_RATE, 0u, 0u, 0u};
+  return state;
+}
+
+/**
+ *   @brief queue one frame if the rate and the UART's free space allow it, never blocks
+ */
+inline bool myosaTrace(uint8_t id, int32_t value)
+{
+  myosaTraceState_t &st = myosaTraceState();
+  uint32_t now = millis();
+  uint32_t refill = ((now - st.lastRefillMs) * MYOSA_TRACE_RATE) / 1000u;
+  if(refill > 0u)
+  {
+    st.tokens = (st.tokens + refill > MYOSA_TRACE_RATE) ? MYOSA_TRACE_RATE : st.tokens + refill;
+    st.lastRefillMs = now;
+  }
+  if((st.tokens == 0u) || (MYOSA_LOG_PORT.availableForWrite() < (int)MYOSA_TRACE_FRAME_BYTES))
+  {
+    st.dropped++;
+    return false;
+  }
+  uint8_t frame[MYOSA_TRACE_FRAME_BYTES] =
+  {
+    MYOSA_TRACE_SYNC, id, (uint8_t)now, (uint8_t)(now >> 8),
+    (uint8_t)value, (uint8_t)((uint32_t)value >> 8), (uint8_t)((uint32_t)value >> 16), (uint8_t)((uint32_t)value >> 24)
+  };
+  MYOSA_LOG_PORT.write(frame, sizeof(frame));
+  st.tokens--;
+  st.sent++;
+  return true;
+}
+
+#define MYOSA_TRACE(id, value)    myosaTrace((uint8_t)(id), (int32_t)(value))
+
+#else
+
+#define MYOSA_TRACE(id, value)    do { } while(0)
+
+#endif
+
+#endif
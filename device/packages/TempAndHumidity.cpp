@@ -33,6 +33,7 @@ TempAndHumidity::TempAndHumidity()
 {
   _i2cSlaveAddress = Si7021_I2C_ADDRESS;
   _isConnected = false;
+  i2c_init();
 }
 
 /**
@@ -77,7 +78,7 @@ bool TempAndHumidity::ping(void)
 /**
  *
  */
-float TempAndHumidity::getRelativeHumdity(bool print)
+float TempAndHumidity::getRelativeHumdity(void)
 {
   uint8_t data[3u];
   uint16_t RH_Code;
@@ -91,32 +92,27 @@ float TempAndHumidity::getRelativeHumdity(bool print)
   do {
     if(writeByte(Si7021_MEAS_RH_NOHOLD_MODE) == false)
     {
-      RH = 0.f;
+      RH = NAN;
       continue;
     }
     delay_ms(25);
     if(readMultiBytes(3u,data) == false)
     {
-      RH = 0.f;
+      RH = NAN;
       continue;
     }
     RH_Code = ((uint16_t)data[0u] << 8u)|data[1u];
     RH      = (((125.f*(float)RH_Code)/65536.f)-6.f);
   }while(0);
-  /* print the value on serial terminal if required */
-  if(print)
-  {
-    Serial.print("Relative Humidity (%): ");
-    Serial.print(RH,2);
-    Serial.println("%");
-  }
+  /* log the value when built with MYOSA_LOG_INFO */
+  MYOSA_LOGI("Relative Humidity (%): ", RH, "%");
   return RH;
 }
 
 /**
  *
  */
-float TempAndHumidity::getTempC(bool print)
+float TempAndHumidity::getTempC(void)
 {
   uint8_t data[3u];
   uint16_t Temp_Code;
@@ -130,50 +126,40 @@ float TempAndHumidity::getTempC(bool print)
   do {
     if(writeByte(Si7021_MEAS_TEMP_NOHOLD_MODE) == false)
     {
-      temperature = 0.f;
+      temperature = NAN;
       continue;
     }
     delay_ms(25);
     if(readMultiBytes(3u,data) == false)
     {
-      temperature = 0.f;
+      temperature = NAN;
       continue;
     }
     Temp_Code   = ((uint16_t)data[0u] << 8u)|data[1u];
     temperature = (((175.72f*(float)Temp_Code)/65536.f)-46.85f);
   } while(0);
-  /* print the value on serial terminal if required */
-  if(print)
-  {
-    Serial.print("Temperature (°C): ");
-    Serial.print(temperature,2);
-    Serial.println("°C");
-  }
+  /* log the value when built with MYOSA_LOG_INFO */
+  MYOSA_LOGI("Temperature (°C): ", temperature, "°C");
   return temperature;
 }
 
 /**
  *
  */
-float TempAndHumidity::getTempF(bool print)
+float TempAndHumidity::getTempF(void)
 {
-  float temperature = (getTempC(false) * (9.f / 5.f)) + 32.f;
-  if(print)
-  {
-    Serial.print("Temperature (°F): ");
-    Serial.print(temperature,2);
-    Serial.println("°F");
-  }
+  float temperature = (getTempC() * (9.f / 5.f)) + 32.f;
+  MYOSA_LOGI("Temperature (°F): ", temperature, "°F");
   return temperature;
 }
 
 /**
  *
  */
- float TempAndHumidity::getHeatIndexC(bool print)
+ float TempAndHumidity::getHeatIndexC(void)
  {
-   float T = getTempC(false);
-   float RH = getRelativeHumdity(false);
+   float T = getTempC();
+   float RH = getRelativeHumdity();
    float HI = 0.f;
 
     float c1 = -8.78469475556;
@@ -186,12 +172,7 @@ float TempAndHumidity::getTempF(bool print)
     float c8 = 0.00072546;
     float c9 = -0.000003582;
    HI = c1 + (c2*T) + (c3*RH) + (c4*T*RH) + (c5*T*T) + (c6*RH*RH) + (c7*T*T*RH) + (c8*T*RH*RH) + (c9*T*T*RH*RH);
-    if(print)
-    {
-      Serial.print("Heat Index (°C): ");
-      Serial.print(HI,2);
-      Serial.println("°C");
-    }
+    MYOSA_LOGI("Heat Index (°C): ", HI, "°C");
    return HI;
  }
 
@@ -199,20 +180,15 @@ float TempAndHumidity::getTempF(bool print)
 /**
  *
  */
-float TempAndHumidity::getHeatIndexF(bool print)
+float TempAndHumidity::getHeatIndexF(void)
 {
-  float T = getTempF(false);
-  float RH = getRelativeHumdity(false);
+  float T = getTempF();
+  float RH = getRelativeHumdity();
   float HI = 0.f;
   HI = -42.379f + (2.04901523f*T) + (10.14333127f*RH) - (0.22475541f*T*RH) -
        (0.00683783f*T*T) - (0.05481717f*RH*RH) + (0.00122874f*T*T*RH) +
        (0.00085282f*T*RH*RH) - (0.00000199f*T*T*RH*RH);
-   if(print)
-   {
-     Serial.print("Heat Index (°F): ");
-     Serial.print(HI,2);
-     Serial.println("°F");
-   }
+   MYOSA_LOGI("Heat Index (°F): ", HI, "°F");
   return HI;
 }
 
@@ -244,9 +220,7 @@ uint64_t TempAndHumidity::getSerialNumber(void)
                       ((uint64_t)data[6u]));
     }
   }
-  Serial.print("Temperature and Humidity Sensor Serial Number: 0x");
-  Serial.print((uint32_t)(serialNumber>>32),HEX);
-  Serial.println((uint32_t)serialNumber,HEX);
+  MYOSA_LOGD("Temperature and Humidity Sensor Serial Number: 0x", myosaHex((uint32_t)(serialNumber>>32)), myosaHex((uint32_t)serialNumber));
   return serialNumber;
 }
 
@@ -272,21 +246,59 @@ char *TempAndHumidity::getFirmwareVersion(void)
       }
     }
   }
-  Serial.print("Si7021 Chip Firmware Revision: ");
-  Serial.println(version);
+  MYOSA_LOGD("Si7021 Chip Firmware Revision: ", version);
   return version;
 }
 
+/**
+ *   @brief start an RH conversion in No Hold Master mode and return immediately
+ */
+bool TempAndHumidity::startHumidity(void)
+{
+  return writeByte(Si7021_MEAS_RH_NOHOLD_MODE);
+}
+
+/**
+ *   @brief false while the conversion is still running (the Si7021 NACKs its address)
+ */
+bool TempAndHumidity::readHumidityResult(float *rh)
+{
+  uint8_t data[3u];
+  uint16_t RH_Code;
+  if(readMultiBytes(3u,data) == false)
+  {
+    return false;
+  }
+  RH_Code = ((uint16_t)data[0u] << 8u)|data[1u];
+  *rh     = (((125.f*(float)RH_Code)/65536.f)-6.f);
+  return true;
+}
+
+/**
+ *   @brief temperature measured as part of the last RH conversion, no new conversion needed
+ */
+bool TempAndHumidity::readTempFromHumidity(float *tempC)
+{
+  uint8_t data[2u];
+  uint16_t Temp_Code;
+  if(readMultiBytes(Si7021_READ_TEMP_PREV_RH_MEAS,2u,data) == false)
+  {
+    return false;
+  }
+  Temp_Code = ((uint16_t)data[0u] << 8u)|data[1u];
+  *tempC    = (((175.72f*(float)Temp_Code)/65536.f)-46.85f);
+  return true;
+}
+
 /***********************************************************************************************
  * Platform dependent routines. Change these functions implementation based on microcontroller *
  ***********************************************************************************************/
 /**
- *
+ *   @brief attach to the shared bus, which starts with the first transaction
  */
 void TempAndHumidity::i2c_init(void)
 {
-  Wire.begin();
-  Wire.setClock(100000);
+  _bus = I2cBus::shared().attach(_i2cSlaveAddress, Si7021_I2C_MAX_HZ, "si7021");
 }
 
 /**
@@ -294,18 +306,10 @@ void TempAndHumidity::i2c_init(void)
  */
 bool TempAndHumidity::readByte(uint8_t reg, uint8_t *in)
 {
-  Wire.beginTransmission((uint8_t)_i2cSlaveAddress);
-  Wire.write(reg);
-  if(Wire.endTransmission(true) != 0)
-  {
-    return false;
-  }
-  Wire.requestFrom((uint8_t)_i2cSlaveAddress, (uint8_t)1u, (uint8_t)1u);
-  if(Wire.available() != 1u)
+  if(I2cBus::shared().read(_bus, reg, in, 1u) != I2C_RESULT_OK)
   {
     return false;
   }
-  *in = Wire.read();
   return true;
 }
 
@@ -314,22 +318,10 @@ bool TempAndHumidity::readByte(uint8_t reg, uint8_t *in)
  */
 bool TempAndHumidity::readMultiBytes(uint8_t reg, uint8_t length, uint8_t *in)
 {
-  Wire.beginTransmission((uint8_t)_i2cSlaveAddress);
-  Wire.write(reg);
-  if(Wire.endTransmission(true) != 0)
-  {
-    return false;
-  }
-  Wire.requestFrom((uint8_t)_i2cSlaveAddress, (uint8_t)length, (uint8_t)1u);
-  if(Wire.available() != length)
+  if(I2cBus::shared().read(_bus, reg, in, length) != I2C_RESULT_OK)
   {
     return false;
   }
-  uint8_t nData;
-  for(nData = 0u; nData < length; nData++)
-  {
-    in[nData] = Wire.read();
-  }
   return true;
 }
 
@@ -338,17 +330,7 @@ bool TempAndHumidity::readMultiBytes(uint8_t reg, uint8_t length, uint8_t *in)
  */
 bool TempAndHumidity::readMultiBytes(uint8_t length, uint8_t *in)
 {
-  Wire.requestFrom((uint8_t)_i2cSlaveAddress, (uint8_t)length, (uint8_t)1u);
-  if(Wire.available() != length)
-  {
-    return false;
-  }
-  uint8_t nData;
-  for(nData = 0u; nData < length; nData++)
-  {
-    in[nData] = Wire.read();
-  }
-  return true;
+  return I2cBus::shared().receive(_bus, in, length) == I2C_RESULT_OK;
 }
 
 /**
@@ -356,13 +338,11 @@ bool TempAndHumidity::readMultiBytes(uint8_t length, uint8_t *in)
  */
 bool TempAndHumidity::writeByte(uint8_t reg)
 {
-  Wire.beginTransmission((uint8_t)_i2cSlaveAddress);
-  Wire.write(reg);
-  if (Wire.endTransmission(true) == 0)
+  if(I2cBus::shared().write(_bus, reg, NULL, 0u) != I2C_RESULT_OK)
   {
-    return true;
+    return false;
   }
-  return false;
+  return true;
 }
 
 /**
@@ -370,14 +350,11 @@ bool TempAndHumidity::writeByte(uint8_t reg)
  */
 bool TempAndHumidity::writeByte(uint8_t reg, uint8_t val)
 {
-  Wire.beginTransmission((uint8_t)_i2cSlaveAddress);
-  Wire.write(reg);
-  Wire.write(val);
-  if (Wire.endTransmission(true) == 0)
+  if(I2cBus::shared().write(_bus, reg, &val, 1u) != I2C_RESULT_OK)
   {
-    return true;
+    return false;
   }
-  return false;
+  return true;
 }
 
 /**
@@ -385,12 +362,15 @@ bool TempAndHumidity::writeByte(uint8_t reg, uint8_t val)
  */
 bool TempAndHumidity::writeAddress(void)
 {
-  Wire.beginTransmission((uint8_t)_i2cSlaveAddress);
-  if (Wire.endTransmission(true) == 0)
-  {
-    return true;
-  }
-  return false;
+  return I2cBus::shared().probe(_bus);
+}
+
+/**
+ *
+ */
+I2cResult TempAndHumidity::busResult(void) const
+{
+  return I2cBus::shared().lastResult(_bus);
 }
 
 /**
@@ -30,8 +30,11 @@
 #include <stdint.h>
 #include <Arduino.h>
 #include <Wire.h>
+#include <MyosaLog.h>
+#include <I2cBus.h>
 
 #define Si7021_I2C_ADDRESS              0x40u
+#define Si7021_I2C_MAX_HZ               400000u   /**< fast mode */
 #define Si7021_SOFT_RESET_DELAY         0x0Fu
 #define Si7021_MEAS_RH_HOLD_MODE        0xE5u   /**< Measure Relative Humidity, Hold Master Mode */
 #define Si7021_MEAS_RH_NOHOLD_MODE      0xF5u   /**< Measure Relative Humidity, No Hold Master Mode */
@@ -70,15 +73,23 @@ class TempAndHumidity
     bool begin(void);
     bool reset(void);
     bool ping(void);
-    float getRelativeHumdity(bool print=true);
-    float getTempC(bool print=true);
-    float getTempF(bool print=true);
-    float getHeatIndexC(bool print=true);
-    float getHeatIndexF(bool print=true);
+    /* outcome of the last bus transaction, the reason when a call above failed */
+    I2cResult busResult(void) const;
+    /* NAN when the bus transaction failed */
+    float getRelativeHumdity(void);
+    float getTempC(void);
+    float getTempF(void);
+    float getHeatIndexC(void);
+    float getHeatIndexF(void);
     uint64_t getSerialNumber(void);
     char *getFirmwareVersion(void);
+    /* Non-blocking measurement: start, poll until a result arrives, then collect */
+    bool startHumidity(void);
+    bool readHumidityResult(float *rh);
+    bool readTempFromHumidity(float *tempC);
   private:
     uint8_t _i2cSlaveAddress;
+    int8_t _bus;                  /**< I2cBus handle */
     bool _isConnected;
     void i2c_init(void);
     bool readByte(uint8_t reg, uint8_t *in);